@@ -0,0 +1,75 @@
+// Measures the cost of constructing a single tangent arc (ArcNode) after a section and after another arc.
+// Arcs are built on the same store again and again, so only the construction is measured, not the polyline growth.
+//
+// build: g++ -O2 -std=c++14 -I../Project15 ArcConstructionBenchmark.cpp ../Project15/Polyline.cpp ../Project15/Primitives.cpp ../Project15/Tessellation.cpp
+
+#include "Polyline.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+using namespace obj;
+using std::vector;
+
+
+
+vector<Point<double>> createPoints(unsigned int count)
+{
+	std::mt19937 generator(2019);										// seeded, so every run measures the same points
+	std::uniform_real_distribution<double> coordinate(-1, 1);
+
+	vector<Point<double>> points;
+	for (unsigned int i = 0; i < count; i++)
+		points.push_back(Point<double>(coordinate(generator), coordinate(generator)));
+	return points;
+}
+
+
+double measure(NodeStore& nodes, vector<Point<double>>& points, unsigned int& createdArcs)
+{
+	double checksum = 0;
+	createdArcs = 0;
+
+	auto begin = std::chrono::steady_clock::now();
+	for (auto& point : points)
+	{
+		auto arcNode = ArcNode(nodes, point);
+		if (!arcNode.isValid()) continue;
+
+		checksum += arcNode.getNode().arc.getRadius();
+		createdArcs++;
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	if (checksum == 0) std::printf("no arcs were created\n");			// uses checksum, so construction isn't optimized away
+	return std::chrono::duration<double, std::nano>(end - begin).count() / points.size();
+}
+
+
+int main()
+{
+	const unsigned int arcsCount = 1000000;
+	auto points = createPoints(arcsCount);
+
+	auto firstPoint = Point<double>(0, 0);
+	auto sectionEnd = Point<double>(0.3, 0.1);
+	auto arcEnd = Point<double>(0.5, 0.6);
+
+	PolyLine afterSection(firstPoint);
+	afterSection.addLine(sectionEnd);
+
+	PolyLine afterArc(firstPoint);
+	afterArc.addLine(sectionEnd);
+	afterArc.addArc(arcEnd);
+
+	unsigned int createdArcs;
+	double sectionTime = measure(afterSection.getNodes(), points, createdArcs);
+	std::printf("arc after section: %8.1f ns per arc (%u arcs)\n", sectionTime, createdArcs);
+
+	double arcTime = measure(afterArc.getNodes(), points, createdArcs);
+	std::printf("arc after arc:     %8.1f ns per arc (%u arcs)\n", arcTime, createdArcs);
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+// Compares arc tessellation made with rotation recurrence (ArcTessellator) with the old per vertex sin/cos version.
+// Prints time of both versions and the biggest distance between their vertexes (relative to radius).
+//
+// build: g++ -O2 -std=c++14 -I../Project15 ArcTessellationBenchmark.cpp ../Project15/Primitives.cpp ../Project15/Tessellation.cpp
+
+#include "Primitives.h"
+#include "Tessellation.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+using namespace primitives;
+using std::vector;
+
+
+
+// the old way of generating vertexes: every vertex is rotated with Vector::rotate, which calls sin and cos
+// steps are counted, because the old loop never ended when the last step crossed 2 * pi (rotation was wrapped back to 0)
+void legacyGenerateVertexes(Point<double> center, double radius, Radians beginPointAngle, Radians endPointAngle, bool counterClockWise, VertexBuffer<double>& vertexBuffer, unsigned int sections)
+{
+	auto centerVector = Vector<double>(center);
+	Radians translatedEndPointRotation;
+	translatedEndPointRotation = endPointAngle - beginPointAngle;
+
+	auto rotatingVector = Vector<double>(radius, 0);
+	rotatingVector.rotate(beginPointAngle);
+	Radians rotation = 0;
+	Radians circleSection;
+	circleSection.value /= sections;
+	unsigned int steps = 1;
+
+	if (counterClockWise)
+	{
+		rotatingVector.rotate(circleSection);
+		rotation += circleSection;
+		while ((rotation < translatedEndPointRotation) && (steps++ < sections))
+		{
+			Point<double> circlePoint = Point<double>(rotatingVector);
+			circlePoint.move(centerVector);
+			vertexBuffer.add(circlePoint);
+			rotatingVector.rotate(circleSection);
+			rotation += circleSection;
+		}
+	}
+	else
+	{
+		rotatingVector.rotate(-1 * circleSection);
+		rotation -= circleSection;
+		while ((rotation > translatedEndPointRotation) && (steps++ < sections))
+		{
+			Point<double> circlePoint = Point<double>(rotatingVector);
+			circlePoint.move(centerVector);
+			vertexBuffer.add(circlePoint);
+			rotatingVector.rotate(-1 * circleSection);
+			rotation -= circleSection;
+		}
+	}
+
+	auto lastPointVector = Vector<double>(radius, 0);
+	lastPointVector.rotate(endPointAngle);
+	auto lastPoint = Point<double>(lastPointVector);
+	lastPoint.move(centerVector);
+	vertexBuffer.add(lastPoint);
+}
+
+
+struct ArcSample
+{
+	Point<double> center;
+	double radius;
+	Radians beginAngle;
+	Radians endAngle;
+	bool counterClockWise;
+
+	double sweep()
+	{
+		Radians rotation;
+		rotation = endAngle - beginAngle;
+		return counterClockWise ? rotation.value : -(2 * pi - rotation.value);
+	}
+};
+
+
+vector<ArcSample> createSamples(unsigned int count)
+{
+	std::mt19937 generator(2019);													// seeded, so every run measures the same arcs
+	std::uniform_real_distribution<double> coordinate(-1, 1);
+	std::uniform_real_distribution<double> radius(0.001, 1);
+	std::uniform_real_distribution<double> angle(0, 2 * pi);
+
+	vector<ArcSample> samples;
+	for (unsigned int i = 0; i < count; i++)
+		samples.push_back({ Point<double>(coordinate(generator), coordinate(generator)), radius(generator), Radians(angle(generator)), Radians(angle(generator)), (i % 2 == 0) });
+	return samples;
+}
+
+
+int main()
+{
+	const unsigned int arcsCount = 20000;
+	const unsigned int accuracies[] = { 64, 256, 1024, 4096 };
+	auto samples = createSamples(arcsCount);
+
+	std::printf("%10s %14s %14s %10s %16s\n", "sections", "legacy [ms]", "recurrence [ms]", "speedup", "max deviation/r");
+
+	for (auto sections : accuracies)
+	{
+		VertexBuffer<double> legacyVertexes;
+		auto legacyBegin = std::chrono::steady_clock::now();
+		for (auto& sample : samples)
+			legacyGenerateVertexes(sample.center, sample.radius, sample.beginAngle, sample.endAngle, sample.counterClockWise, legacyVertexes, sections);
+		auto legacyEnd = std::chrono::steady_clock::now();
+
+		VertexBuffer<double> vertexes;
+		auto recurrenceBegin = std::chrono::steady_clock::now();
+		for (auto& sample : samples)
+		{
+			auto tessellator = ArcTessellator(sample.center, sample.radius, sample.beginAngle, sample.sweep());
+			tessellator.generateVertexes(vertexes, sections);
+		}
+		auto recurrenceEnd = std::chrono::steady_clock::now();
+
+		// vertexes are compared arc by arc, vertex counts can differ by one when the last step lands right on the end point
+		double maxDeviation = 0;
+		for (auto& sample : samples)
+		{
+			VertexBuffer<double> legacyArc, arc;
+			legacyGenerateVertexes(sample.center, sample.radius, sample.beginAngle, sample.endAngle, sample.counterClockWise, legacyArc, sections);
+			auto tessellator = ArcTessellator(sample.center, sample.radius, sample.beginAngle, sample.sweep());
+			tessellator.generateVertexes(arc, sections);
+
+			size_t comparedCount = (legacyArc.size() < arc.size()) ? legacyArc.size() - 1 : arc.size() - 1;
+			for (size_t i = 0; i < comparedCount; i++)
+			{
+				auto legacyVertex = legacyArc[i];
+				auto vertex = arc[i];
+				auto deviation = Vector<double>(legacyVertex, vertex).getLength() / sample.radius;
+				if (deviation > maxDeviation) maxDeviation = deviation;
+			}
+
+			auto legacyEnd = legacyArc[legacyArc.size() - 1];
+			auto end = arc[arc.size() - 1];
+			auto endDeviation = Vector<double>(legacyEnd, end).getLength() / sample.radius;
+			if (endDeviation > maxDeviation) maxDeviation = endDeviation;
+		}
+
+		double legacyTime = std::chrono::duration<double, std::milli>(legacyEnd - legacyBegin).count();
+		double recurrenceTime = std::chrono::duration<double, std::milli>(recurrenceEnd - recurrenceBegin).count();
+		std::printf("%10u %14.2f %14.2f %9.1fx %16.3e\n", sections, legacyTime, recurrenceTime, legacyTime / recurrenceTime, maxDeviation);
+	}
+
+	return 0;
+}
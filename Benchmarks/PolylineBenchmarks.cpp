@@ -0,0 +1,727 @@
+// Performance suite of the core library, made with Google Benchmark. Input polylines are random walks from seeded generators,
+// so every run (and every release) measures the same shapes.
+//
+// results as JSON: PolylineBenchmarks --benchmark_out=results.json --benchmark_out_format=json
+// (or build target polyline_benchmarks_json, which writes polyline_benchmarks.json in the build directory)
+
+#include "Document.h"
+#include "DxfFile.h"
+#include "Polyline.h"
+#include "PolylineControler.h"
+#include "PolylineFile.h"
+#include "Scene.h"
+#include "Snapping.h"
+#include "Transform.h"
+#include "AllocationCounter.h"										// every global allocation of the benchmark binary is counted, so benchmarks can report allocations per item
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+using namespace controler;
+using std::vector;
+
+
+
+const unsigned int seed = 2019;
+
+
+// sets counter "allocs" to allocations per item. They're counted around measured code only, benchmark library allocates between iterations too
+void reportAllocations(benchmark::State& state, size_t allocations, size_t items)
+{
+	state.counters["allocs"] = (items > 0) ? static_cast<double>(allocations) / items : static_cast<double>(allocations);
+}
+
+
+// points of a random walk with short steps, like nodes clicked one after another. Walk is pulled to the center, so it stays on screen
+vector<Point<double>> createRandomWalk(size_t count, unsigned int walkSeed = seed)
+{
+	std::mt19937 generator(walkSeed);
+	std::uniform_real_distribution<double> move(-0.05, 0.05);
+
+	vector<Point<double>> points;
+	points.reserve(count);
+	auto point = Point<double>(0, 0);
+	for (size_t i = 0; i < count; i++)
+	{
+		point = Point<double>(0.95 * point.x + move(generator), 0.95 * point.y + move(generator));
+		points.push_back(point);
+	}
+	return points;
+}
+
+
+// polyline with lines and arcs one after another, arcs that can't be made are skipped
+unique_ptr<PolyLine> createPolyLine(vector<Point<double>>& points)
+{
+	auto firstPoint = Point<double>(0, 0);
+	auto polyLine = make_unique<PolyLine>(firstPoint);
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		if (i % 2 == 0) polyLine->addLine(points[i]);
+		else polyLine->addArc(points[i]);
+	}
+	return polyLine;
+}
+
+
+
+
+// PolyLine::addLine, whole chain of state.range(0) nodes is made in every iteration
+
+static void BM_AddLine(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto firstPoint = Point<double>(0, 0);
+
+	for (auto _ : state)
+	{
+		PolyLine polyLine(firstPoint);
+		for (auto& point : points)
+			polyLine.addLine(point);
+		benchmark::DoNotOptimize(polyLine.lastNodeIndex());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddLine)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+
+// PolyLine::addArc, every arc is tangent to the previous one
+
+static void BM_AddArc(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto firstPoint = Point<double>(0, 0);
+	auto firstSectionEnd = Point<double>(0.01, 0);
+
+	for (auto _ : state)
+	{
+		PolyLine polyLine(firstPoint);
+		polyLine.addLine(firstSectionEnd);
+		for (auto& point : points)
+			polyLine.addArc(point);
+		benchmark::DoNotOptimize(polyLine.lastNodeIndex());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddArc)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+
+
+
+// PolyLine::generateVertexChain. Accuracy is number of sections per circle, 0 means 0.25 pixel deviation in 768 pixels high window.
+// Tessellated polyline: vertexes are cached in polyline, so a new polyline is made (not measured) before every iteration.
+// Cached polyline: what displaying a polyline that hasn't changed costs
+
+ArcAccuracy benchmarkAccuracy(int64_t accuracy)
+{
+	if (accuracy == 0) return ArcAccuracy::fromDeviation(0.25 * 2.0 / 768);
+	return ArcAccuracy(static_cast<unsigned int>(accuracy));
+}
+
+
+static void BM_GenerateVertexChain_Tessellated(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto accuracy = benchmarkAccuracy(state.range(1));
+	VertexBuffer<double> vertexBuffer;
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		auto polyLine = createPolyLine(points);
+		vertexBuffer.clear();
+		state.ResumeTiming();
+
+		polyLine->generateVertexChain(vertexBuffer, accuracy);
+		benchmark::DoNotOptimize(vertexBuffer.getX());
+
+		state.PauseTiming();
+		polyLine.reset();
+		state.ResumeTiming();
+	}
+	state.counters["vertexes"] = static_cast<double>(vertexBuffer.size());
+	state.SetItemsProcessed(state.iterations() * vertexBuffer.size());
+}
+BENCHMARK(BM_GenerateVertexChain_Tessellated)->ArgsProduct({ { 10000, 100000 }, { 16, 64, 256, 0 } })->Unit(benchmark::kMillisecond);
+
+
+// parallel tessellation of 1M nodes on pools of 1 to N workers (with the calling thread). Vertexes are the same as serial ones,
+// so only time should change
+
+static void BM_GenerateVertexChain_Parallel(benchmark::State& state)
+{
+	auto points = createRandomWalk(1000000);
+	auto accuracy = benchmarkAccuracy(0);
+	WorkStealingPool pool(static_cast<unsigned int>(state.range(0)));
+	VertexBuffer<double> vertexBuffer;
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		auto polyLine = createPolyLine(points);
+		polyLine->setTessellationPool(&pool);
+		vertexBuffer.clear();
+		state.ResumeTiming();
+
+		polyLine->generateVertexChain(vertexBuffer, accuracy);
+		benchmark::DoNotOptimize(vertexBuffer.getX());
+
+		state.PauseTiming();
+		polyLine.reset();
+		state.ResumeTiming();
+	}
+	state.counters["threads"] = pool.size();
+	state.SetItemsProcessed(state.iterations() * vertexBuffer.size());
+}
+BENCHMARK(BM_GenerateVertexChain_Parallel)->DenseRange(1, 4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+static void BM_GenerateVertexChain_Cached(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto accuracy = benchmarkAccuracy(state.range(1));
+	auto polyLine = createPolyLine(points);
+	VertexBuffer<double> vertexBuffer;
+	polyLine->generateVertexChain(vertexBuffer, accuracy);							// fills the cache before measuring
+
+	for (auto _ : state)
+	{
+		vertexBuffer.clear();
+		polyLine->generateVertexChain(vertexBuffer, accuracy);
+		benchmark::DoNotOptimize(vertexBuffer.getX());
+	}
+	state.counters["vertexes"] = static_cast<double>(vertexBuffer.size());
+	state.SetItemsProcessed(state.iterations() * vertexBuffer.size());
+}
+BENCHMARK(BM_GenerateVertexChain_Cached)->ArgsProduct({ { 10000, 100000 }, { 16, 64, 256, 0 } })->Unit(benchmark::kMillisecond);
+
+
+// culling: long polyline that goes to the right (1M nodes), window sees 1 / zoom of its width. Only chunks of nodes that intersect
+// the window are copied from cache, so the cost should fall with zoom. Vertexes are cached before measuring, like in the editor
+
+static void BM_GenerateVisibleVertexChain(benchmark::State& state)
+{
+	auto points = createRandomWalk(1000000);
+	for (size_t i = 0; i < points.size(); i++)
+		points[i].x += 0.01 * i;
+	auto polyLine = createPolyLine(points);
+	auto accuracy = benchmarkAccuracy(0);
+
+	auto box = polyLine->getBoundingBox();
+	double width = (box.maxPoint.x - box.minPoint.x) / state.range(0);
+	double middle = (box.minPoint.x + box.maxPoint.x) / 2;
+	auto area = BoundingBox<double>(Point<double>(middle - width / 2, box.minPoint.y), Point<double>(middle + width / 2, box.maxPoint.y));
+
+	VertexBuffer<double> vertexBuffer;
+	vector<size_t> stripEnds;
+	polyLine->generateVertexChain(vertexBuffer, accuracy);							// fills the cache before measuring
+
+	for (auto _ : state)
+	{
+		vertexBuffer.clear();
+		stripEnds.clear();
+		polyLine->generateVisibleVertexChain(vertexBuffer, stripEnds, accuracy, area);
+		benchmark::DoNotOptimize(vertexBuffer.getX());
+	}
+	state.counters["vertexes"] = static_cast<double>(vertexBuffer.size());
+}
+BENCHMARK(BM_GenerateVisibleVertexChain)->RangeMultiplier(10)->Range(1, 1000)->Unit(benchmark::kMicrosecond);
+
+
+
+
+// distance queries: the same long polyline going to the right, cursors are near its nodes like in hover. Box hierarchy leaves
+// only blocks of nodes around the cursor (and blocks of the few huge arcs that random walk makes), so query time grows slowly
+// with length. Batch is 100k queries on 1 thread and on all cores
+
+unique_ptr<PolyLine> createLongPolyLine(size_t count)
+{
+	auto points = createRandomWalk(count);
+	for (size_t i = 0; i < points.size(); i++)
+		points[i].x += 0.01 * i;
+	return createPolyLine(points);
+}
+
+
+vector<Point<double>> createCursors(PolyLine& polyLine, size_t count)
+{
+	std::mt19937 generator(seed + 1);
+	std::uniform_int_distribution<size_t> node(0, polyLine.lastNodeIndex());
+	std::uniform_real_distribution<double> move(-0.02, 0.02);
+
+	vector<Point<double>> cursors;
+	for (size_t i = 0; i < count; i++)
+	{
+		auto point = polyLine.getNodes().getEndPointAt(node(generator));
+		cursors.push_back(Point<double>(point.x + move(generator), point.y + move(generator)));
+	}
+	return cursors;
+}
+
+
+static void BM_PolyLineClosestPoint(benchmark::State& state)
+{
+	auto polyLine = createLongPolyLine(state.range(0));
+	auto cursors = createCursors(*polyLine, 1024);
+	size_t i = 0;
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(polyLine->findClosestPoint(cursors[i++ & 1023]));
+}
+BENCHMARK(BM_PolyLineClosestPoint)->RangeMultiplier(100)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_PolyLineClosestPoints_Batch(benchmark::State& state)
+{
+	auto polyLine = createLongPolyLine(1000000);
+	auto cursors = createCursors(*polyLine, 100000);
+	vector<ClosestPoint> closestPoints;
+	WorkStealingPool pool(static_cast<unsigned int>(state.range(0)));	// 0 uses all cores
+	polyLine->setTessellationPool(&pool);
+
+	for (auto _ : state)
+	{
+		polyLine->findClosestPoints(cursors, closestPoints);
+		benchmark::DoNotOptimize(closestPoints.data());
+	}
+	state.SetItemsProcessed(state.iterations() * cursors.size());
+}
+BENCHMARK(BM_PolyLineClosestPoints_Batch)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+
+
+// ArcNode construction, the same store is used again and again, so only the arc is measured and not polyline growth
+
+static void measureArcNode(benchmark::State& state, NodeStore& nodes)
+{
+	auto points = createRandomWalk(4096);
+	size_t i = 0;
+
+	for (auto _ : state)
+	{
+		auto arcNode = ArcNode(nodes, points[i]);
+		if (arcNode.isValid()) benchmark::DoNotOptimize(arcNode.getNode().arc.getRadius());
+		i = (i + 1) % points.size();
+	}
+}
+
+
+static void BM_ArcNode_AfterSection(benchmark::State& state)
+{
+	auto firstPoint = Point<double>(0, 0);
+	auto sectionEnd = Point<double>(0.3, 0.1);
+	PolyLine polyLine(firstPoint);
+	polyLine.addLine(sectionEnd);
+
+	measureArcNode(state, polyLine.getNodes());
+}
+BENCHMARK(BM_ArcNode_AfterSection);
+
+
+static void BM_ArcNode_AfterArc(benchmark::State& state)
+{
+	auto firstPoint = Point<double>(0, 0);
+	auto sectionEnd = Point<double>(0.3, 0.1);
+	auto arcEnd = Point<double>(0.5, 0.6);
+	PolyLine polyLine(firstPoint);
+	polyLine.addLine(sectionEnd);
+	polyLine.addArc(arcEnd);
+
+	measureArcNode(state, polyLine.getNodes());
+}
+BENCHMARK(BM_ArcNode_AfterArc);
+
+
+
+
+// model to screen transform of WindowHandler (scaling by window ratios) on a whole vertex buffer, for every instruction set
+
+static void BM_ModelToScreen(benchmark::State& state)
+{
+	auto instructionSet = static_cast<InstructionSet>(state.range(1));
+	if (instructionSet > AffineTransform::bestInstructionSet())
+	{
+		state.SkipWithError("instruction set isn't supported by this processor");
+		return;
+	}
+
+	auto points = createRandomWalk(state.range(0));
+	VertexBuffer<double> vertexBuffer;
+	for (auto& point : points)
+		vertexBuffer.add(point);
+
+	auto windowOrginalSize = Size<const double>(1024, 768);
+	auto windowSize = Size<int>(1280, 720);
+	benchmark::DoNotOptimize(windowSize);
+	auto modelToScreen = AffineTransform::scaling(windowOrginalSize.height / windowSize.width, windowOrginalSize.height / windowSize.height);
+	auto screenToModel = AffineTransform::scaling(windowSize.width / windowOrginalSize.height, windowSize.height / windowOrginalSize.height);
+	bool toScreen = true;
+
+	for (auto _ : state)
+	{
+		(toScreen ? modelToScreen : screenToModel).apply(vertexBuffer, instructionSet);	// there and back, so values don't grow to infinity or to denormals
+		toScreen = !toScreen;
+		benchmark::DoNotOptimize(vertexBuffer.getX());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ModelToScreen)->ArgsProduct({ { 32768, 1000000 },
+	{ (int64_t)InstructionSet::Scalar, (int64_t)InstructionSet::SSE2, (int64_t)InstructionSet::AVX2 } });
+
+
+
+
+// HistoryHandler storm: state.range(0) nodes are added by the controler, then in every iteration all of them are undone and redone
+
+static void BM_HistoryUndoRedo(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0) + 1);
+	HistoryHandler historyHandler(state.range(0));								// deep enough to undo every node
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+
+	polyLineControler.addNode(points[0]);										// the first node creates polyline, it isn't an event
+	for (size_t i = 1; i < points.size(); i++)
+	{
+		if (i % 2 == 0) polyLineControler.startAddingArcs();
+		else polyLineControler.startAddingLines();
+		polyLineControler.addNode(points[i]);
+	}
+
+	for (auto _ : state)
+	{
+		while (historyHandler.canUndo())
+			historyHandler.undo();
+		while (historyHandler.canRedo())
+			historyHandler.redo();
+	}
+	state.SetItemsProcessed(state.iterations() * 2 * state.range(0));
+}
+BENCHMARK(BM_HistoryUndoRedo)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+
+
+// events added to a full history, the oldest ones are forgotten. Only recording is measured, polyline isn't changed
+
+static void BM_HistoryAddEvent(benchmark::State& state)
+{
+	auto points = createRandomWalk(4096);
+	HistoryHandler historyHandler(state.range(0));
+	size_t i = 0;
+
+	for (auto _ : state)
+	{
+		auto event = Event((i % 2 == 0) ? NodeKind::Line : NodeKind::Arc, points[i]);
+		historyHandler.addEvent(event);
+		i = (i + 1) % points.size();
+	}
+	benchmark::DoNotOptimize(historyHandler.canUndo());
+}
+BENCHMARK(BM_HistoryAddEvent)->Arg(100)->Arg(HistoryHandler::defaultDepth);
+
+
+
+
+
+// binary file: saving and memory mapped loading (with checksum) of polyline with lines and arcs one after another
+
+const char* benchmarkFilePath = "PolylineBenchmarks.pln";
+const char* dxfBenchmarkFilePath = "PolylineBenchmarks.dxf";
+
+
+static void BM_SavePolyLine(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto polyLine = createPolyLine(points);
+
+	for (auto _ : state)
+	{
+		if (!PolylineFile::save(*polyLine, benchmarkFilePath))
+		{
+			state.SkipWithError("file can't be written");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	std::remove(benchmarkFilePath);
+}
+BENCHMARK(BM_SavePolyLine)->RangeMultiplier(10)->Range(1000000, 10000000)->Unit(benchmark::kMillisecond);
+
+
+static void BM_LoadPolyLine(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto polyLine = createPolyLine(points);
+	PolylineFile::save(*polyLine, benchmarkFilePath);
+	polyLine.reset();
+
+	for (auto _ : state)
+	{
+		auto loadedPolyLine = PolylineFile::load(benchmarkFilePath);
+		if (!loadedPolyLine)
+		{
+			state.SkipWithError("file can't be loaded");
+			break;
+		}
+
+		state.PauseTiming();
+		loadedPolyLine.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	std::remove(benchmarkFilePath);
+}
+BENCHMARK(BM_LoadPolyLine)->RangeMultiplier(10)->Range(1000000, 10000000)->Unit(benchmark::kMillisecond);
+
+
+// DXF is text, so throughput is reported in bytes (MB/s) next to nodes per second
+static void BM_DxfExport(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto polyLine = createPolyLine(points);
+
+	for (auto _ : state)
+	{
+		DxfWriter writer(dxfBenchmarkFilePath);
+		writer.write(*polyLine);
+		if (!writer.close())
+		{
+			state.SkipWithError("file can't be written");
+			break;
+		}
+	}
+
+	DxfReader reader(dxfBenchmarkFilePath);
+	while (reader.readPolyLine());
+	state.SetBytesProcessed(state.iterations() * reader.getBytesRead());
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	std::remove(dxfBenchmarkFilePath);
+}
+BENCHMARK(BM_DxfExport)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+
+static void BM_DxfImport(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto polyLine = createPolyLine(points);
+	{
+		DxfWriter writer(dxfBenchmarkFilePath);
+		writer.write(*polyLine);
+	}
+	polyLine.reset();
+
+	uint64_t bytesRead = 0;
+	for (auto _ : state)
+	{
+		DxfReader reader(dxfBenchmarkFilePath);
+		auto importedPolyLine = reader.readPolyLine();
+		if (!importedPolyLine)
+		{
+			state.SkipWithError("file can't be read");
+			break;
+		}
+		bytesRead += reader.getBytesRead();
+
+		state.PauseTiming();
+		importedPolyLine.reset();
+		state.ResumeTiming();
+	}
+	state.SetBytesProcessed(bytesRead);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	std::remove(dxfBenchmarkFilePath);
+}
+BENCHMARK(BM_DxfImport)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+
+
+// document: drawing grows, but density stays the same (polylines are spread over the square that grows with their number),
+// so a window sized area has about the same polylines. The grid should keep query time flat, scan of all boxes grows with the drawing
+
+unique_ptr<Document> createDocument(size_t polyLinesCount)
+{
+	std::mt19937 generator(seed);
+	double side = std::sqrt(static_cast<double>(polyLinesCount)) * 0.1;
+	std::uniform_real_distribution<double> position(-side / 2, side / 2);
+	std::uniform_real_distribution<double> move(-0.02, 0.02);
+
+	auto document = make_unique<Document>();
+	for (size_t i = 0; i < polyLinesCount; i++)
+	{
+		auto point = Point<double>(position(generator), position(generator));
+		auto polyLine = make_unique<PolyLine>(point);
+		for (int j = 0; j < 8; j++)
+		{
+			point = Point<double>(point.x + move(generator), point.y + move(generator));
+			polyLine->addLine(point);
+		}
+		document->add(std::move(polyLine));
+	}
+	return document;
+}
+
+
+static void BM_DocumentFindPolyLines_Grid(benchmark::State& state)
+{
+	auto document = createDocument(state.range(0));
+	auto area = BoundingBox<double>(Point<double>(-1, -1), Point<double>(1, 1));
+	vector<uint32_t> ids;
+
+	for (auto _ : state)
+	{
+		ids.clear();
+		document->findPolyLines(area, ids);
+		benchmark::DoNotOptimize(ids.data());
+	}
+	state.counters["found"] = static_cast<double>(ids.size());
+}
+BENCHMARK(BM_DocumentFindPolyLines_Grid)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_DocumentFindPolyLines_Scan(benchmark::State& state)
+{
+	auto document = createDocument(state.range(0));
+	auto area = BoundingBox<double>(Point<double>(-1, -1), Point<double>(1, 1));
+	vector<uint32_t> ids;
+
+	for (auto _ : state)
+	{
+		ids.clear();
+		for (uint32_t id = 0; id < document->size(); id++)
+			if (document->getBoundingBox(id).intersects(area)) ids.push_back(id);
+		benchmark::DoNotOptimize(ids.data());
+	}
+	state.counters["found"] = static_cast<double>(ids.size());
+}
+BENCHMARK(BM_DocumentFindPolyLines_Scan)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+
+
+
+// snapping: like in document, points are spread over the square that grows with their number, so density stays the same.
+// Radius is 8 pixels at the original zoom and at zoom 100 times lower, where snap index has to use its coarse level
+
+static void BM_SnapFindNearest(benchmark::State& state)
+{
+	std::mt19937 generator(seed);
+	double side = std::sqrt(static_cast<double>(state.range(0))) * 0.02;
+	std::uniform_real_distribution<double> position(-side / 2, side / 2);
+
+	SnapIndex snapIndex;
+	for (int64_t i = 0; i < state.range(0); i++)
+		snapIndex.add(Point<double>(position(generator), position(generator)), SnapKind::EndPoint);
+
+	vector<Point<double>> cursors;
+	for (int i = 0; i < 1024; i++)
+		cursors.push_back(Point<double>(position(generator), position(generator)));
+	double radius = 8.0 / 300 * state.range(1);
+	size_t found = 0;
+	size_t i = 0;
+	SnapPoint snapPoint;
+
+	for (auto _ : state)
+	{
+		found += snapIndex.findNearest(cursors[i++ & 1023], radius, snapPoint);
+		benchmark::DoNotOptimize(snapPoint);
+	}
+	state.counters["found"] = benchmark::Counter(static_cast<double>(found), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SnapFindNearest)->ArgsProduct({ { 10000, 1000000 }, { 1, 100 } })->Unit(benchmark::kMicrosecond);
+
+
+static void BM_SnapAddRemove(benchmark::State& state)
+{
+	auto points = createRandomWalk(1024);
+	SnapIndex snapIndex;
+	for (auto& point : createRandomWalk(state.range(0), seed + 1))
+		snapIndex.add(point, SnapKind::EndPoint);
+
+	size_t allocations = 0;
+	for (auto _ : state)
+	{
+		size_t firstAllocationsCount = allocationsCount;
+		for (auto& point : points)
+			snapIndex.add(point, SnapKind::EndPoint);
+		snapIndex.removeLast(points.size());
+		allocations += allocationsCount - firstAllocationsCount;
+	}
+	state.SetItemsProcessed(state.iterations() * points.size());
+	reportAllocations(state, allocations, state.iterations() * points.size());
+}
+BENCHMARK(BM_SnapAddRemove)->Arg(1000000);
+
+
+// frames of the editor: snapshot of the scene is published and taken like editing thread and display do it, here on one thread. With
+// state.range(1) == 0 nothing changes between frames, so arrays stay as they are; otherwise the view changes every frame and all arrays
+// are made again
+
+static void BM_SceneUpdate(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	HistoryHandler historyHandler;
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+	for (auto& point : points)
+		polyLineControler.addNode(point);
+
+	Camera camera(Size<double>(1024, 768), 384);
+	SceneBuilder sceneBuilder;
+	for (auto _ : state)
+	{
+		if (state.range(1) != 0) sceneBuilder.invalidate();
+		sceneBuilder.publish(polyLineControler, camera);
+		benchmark::DoNotOptimize(sceneBuilder.takeLatest().polyLine);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SceneUpdate)->ArgsProduct({ { 10000, 1000000 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
+
+
+// passive mouse moves in arc mode after state.range(0) nodes: cursor is snapped, display arc is made again and so is the snapshot.
+// After the first frames it shouldn't take anything from global heap, allocs counter shows it
+
+static void BM_MouseTracking(benchmark::State& state)
+{
+	auto points = createRandomWalk(state.range(0));
+	auto cursors = createRandomWalk(1024, seed + 1);
+	HistoryHandler historyHandler;
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		if (i % 2 == 0) polyLineControler.startAddingArcs();
+		else polyLineControler.startAddingLines();
+		polyLineControler.addNode(points[i]);
+	}
+	polyLineControler.startAddingArcs();
+
+	Camera camera(Size<double>(1024, 768), 384);
+	SceneBuilder sceneBuilder;
+	auto moveMouse = [&](size_t i)
+	{
+		auto cursor = polyLineControler.snap(cursors[i & 1023], 8 * camera.getPixelSize());
+		polyLineControler.actualizePolyLine(cursor);
+		sceneBuilder.publish(polyLineControler, camera);
+		benchmark::DoNotOptimize(sceneBuilder.takeLatest().preview);
+	};
+	for (size_t i = 0; i < 1024; i++)							// every cursor once, so all arrays have grown already
+		moveMouse(i);
+
+	size_t i = 0;
+	size_t allocations = 0;
+	for (auto _ : state)
+	{
+		size_t firstAllocationsCount = allocationsCount;
+		moveMouse(i++);
+		allocations += allocationsCount - firstAllocationsCount;
+	}
+	state.SetItemsProcessed(state.iterations());
+	reportAllocations(state, allocations, state.iterations());
+}
+BENCHMARK(BM_MouseTracking)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+// Compares drawing a long polyline in immediate mode (glBegin / glVertex2d for every vertex, the old WindowHandler::displayVertexes)
+// with one glDrawArrays call on a vertex array that is made once and kept between frames. The whole old frame (polyline generated
+// and drawn in immediate mode every frame) is measured too, because vertex arrays are made again only when polyline changes.
+// Runs without a window on an offscreen EGL surface, so it works with software renderers (ex. Mesa llvmpipe) too.
+//
+// build: g++ -O2 -std=c++14 -I../Project15 RenderBenchmark.cpp ../Project15/Polyline.cpp ../Project15/Primitives.cpp ../Project15/Tessellation.cpp -lEGL -lGL
+
+#include "Polyline.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+using namespace obj;
+using std::vector;
+
+
+
+bool createContext()
+{
+	EGLDisplay display = EGL_NO_DISPLAY;
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if ((display == EGL_NO_DISPLAY) || (!eglInitialize(display, nullptr, nullptr))) return false;
+
+	const EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_NONE };
+	EGLConfig config;
+	EGLint configsCount;
+	if ((!eglChooseConfig(display, configAttributes, &config, 1, &configsCount)) || (configsCount == 0)) return false;
+
+	const EGLint surfaceAttributes[] = { EGL_WIDTH, 1024, EGL_HEIGHT, 768, EGL_NONE };
+	EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+	if (surface == EGL_NO_SURFACE) return false;
+
+	eglBindAPI(EGL_OPENGL_API);
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+	if (context == EGL_NO_CONTEXT) return false;
+
+	return (eglMakeCurrent(display, surface, surface, context) == EGL_TRUE);
+}
+
+
+void createPolyLine(unsigned int nodesCount, PolyLine& polyLine)
+{
+	std::mt19937 generator(2019);										// seeded, so every run draws the same polyline
+	std::uniform_real_distribution<double> move(-0.02, 0.02);			// short nodes, like drawn by hand, so filling pixels doesn't hide the cost of sending vertexes
+
+	auto point = Point<double>(0, 0);
+	for (unsigned int i = 0; i < nodesCount; i++)
+	{
+		point = Point<double>(0.9 * point.x + move(generator), 0.9 * point.y + move(generator));
+		if (i % 2 == 0) polyLine.addLine(point);
+		else polyLine.addArc(point);
+	}
+}
+
+
+template<class Function>
+double measure(Function function, unsigned int frames)
+{
+	function();															// the first frame warms up driver
+	glFinish();
+
+	auto begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < frames; i++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT);
+		function();
+		glFinish();														// waits for drawing, not only for sending commands
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - begin).count() / frames;
+}
+
+
+void run(unsigned int nodesCount, unsigned int frames)
+{
+	auto accuracy = ArcAccuracy::fromDeviation(0.25 * 2.0 / 768);
+	auto firstPoint = Point<double>(0, 0);
+	PolyLine polyLine(firstPoint);
+	createPolyLine(nodesCount, polyLine);
+
+	VertexBuffer<double> vertexBuffer;
+	polyLine.generateVertexChain(vertexBuffer, accuracy);
+
+	vector<float> vertexArray;
+	vertexBuffer.copyInterleaved(vertexArray);
+	auto count = static_cast<GLsizei>(vertexBuffer.size());
+
+	double oldFrameTime = measure([&]()
+	{
+		vertexBuffer.clear();
+		polyLine.generateVertexChain(vertexBuffer, accuracy);
+		glBegin(GL_LINE_STRIP);
+		for (size_t i = 0; i < vertexBuffer.size(); i++)
+			glVertex2d(vertexBuffer.getX()[i], vertexBuffer.getY()[i]);
+		glEnd();
+	}, frames);
+
+	double immediateTime = measure([&]()
+	{
+		glBegin(GL_LINE_STRIP);
+		for (size_t i = 0; i < vertexBuffer.size(); i++)
+			glVertex2d(vertexBuffer.getX()[i], vertexBuffer.getY()[i]);
+		glEnd();
+	}, frames);
+
+	double arrayTime = measure([&]()
+	{
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(2, GL_FLOAT, 0, vertexArray.data());
+		glDrawArrays(GL_LINE_STRIP, 0, count);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}, frames);
+
+	std::printf("%7u nodes, %8u vertexes, ms per frame: generated + immediate %8.2f, immediate %8.2f, vertex array %8.2f\n",
+		nodesCount, count, oldFrameTime, immediateTime, arrayTime);
+}
+
+
+int main()
+{
+	if (!createContext())
+	{
+		std::printf("offscreen OpenGL context can't be created\n");
+		return 1;
+	}
+	std::printf("renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+
+	run(1000, 200);
+	run(10000, 50);
+	run(100000, 10);
+	return 0;
+}
@@ -0,0 +1,82 @@
+// Compares model to screen mapping done point by point (the old WindowHandler::translateModelToScreen, with divides for every point)
+// with AffineTransform batches on the whole vertex buffer, for every instruction set this processor supports.
+//
+// build: g++ -O2 -std=c++14 -I../Project15 TransformBenchmark.cpp ../Project15/Transform.cpp ../Project15/Primitives.cpp ../Project15/Tessellation.cpp
+
+#include "Transform.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+using namespace primitives;
+using std::vector;
+
+
+
+// the old way: ratios are computed again with a divide for every point
+void legacyTranslateModelToScreen(Point<double>& point, Size<const double>& windowOrginalSize, Size<int>& windowSize)
+{
+	point.x = windowOrginalSize.height / windowSize.width * point.x;
+	point.y = windowOrginalSize.height / windowSize.height * point.y;
+}
+
+
+template<class Function>
+double measure(Function function, unsigned int repetitions)
+{
+	auto begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < repetitions; i++)
+		function();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - begin).count() / repetitions;
+}
+
+
+void run(unsigned int verticesCount, unsigned int repetitions)
+{
+	std::mt19937 generator(2019);
+	std::uniform_real_distribution<double> coordinate(-1, 1);
+
+	vector<Point<double>> points;
+	VertexBuffer<double> vertexBuffer;
+	for (unsigned int i = 0; i < verticesCount; i++)
+	{
+		auto point = Point<double>(coordinate(generator), coordinate(generator));
+		points.push_back(point);
+		vertexBuffer.add(point);
+	}
+
+	auto windowOrginalSize = Size<const double>(1024, 768);
+	volatile int windowWidth = 768;												// ratios are 1, so after many repetitions values are still the same normal numbers
+	volatile int windowHeight = 768;											// volatile, so compiler doesn't know them and can't remove transform
+	auto windowSize = Size<int>(windowWidth, windowHeight);
+	auto modelToScreen = AffineTransform::scaling(windowOrginalSize.height / windowSize.width, windowOrginalSize.height / windowSize.height);
+
+	std::printf("%u vertexes\n", verticesCount);
+	double legacyTime = measure([&]()
+	{
+		for (auto& point : points)
+			legacyTranslateModelToScreen(point, windowOrginalSize, windowSize);
+	}, repetitions);
+	std::printf("  %-20s %10.1f Mvertexes/s\n", "per point (legacy)", verticesCount / legacyTime / 1000);
+
+	const InstructionSet instructionSets[] = { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2 };
+	const char* names[] = { "batch scalar", "batch SSE2", "batch AVX2" };
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		if (instructionSets[i] > AffineTransform::bestInstructionSet()) break;
+
+		double time = measure([&]() { modelToScreen.apply(vertexBuffer, instructionSets[i]); }, repetitions);
+		std::printf("  %-20s %10.1f Mvertexes/s\n", names[i], verticesCount / time / 1000);
+	}
+}
+
+
+int main()
+{
+	run(32768, 2000);							// fits in cache, shows computing speed
+	run(1000000, 100);							// bigger than cache, shows memory speed
+	return 0;
+}
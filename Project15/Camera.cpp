@@ -0,0 +1,75 @@
+#include "Camera.h"
+
+
+
+namespace primitives
+{
+	// Camera
+
+	Camera::Camera(Size<double> windowSize, double zoom)
+		:	windowSize(windowSize),
+			viewCenter(0, 0),
+			zoom(zoom)
+	{
+		update();
+	}
+
+
+	void Camera::update()
+	{
+		modelToPixels = AffineTransform(
+			zoom, 0, windowSize.width / 2 - zoom * viewCenter.x,
+			0, -zoom, windowSize.height / 2 + zoom * viewCenter.y);
+		pixelsToModel = modelToPixels.inverse();
+
+		double scaleX = 2 * zoom / windowSize.width;
+		double scaleY = 2 * zoom / windowSize.height;
+		modelToScreen = AffineTransform(
+			scaleX, 0, -scaleX * viewCenter.x,
+			0, scaleY, -scaleY * viewCenter.y);
+	}
+
+
+	void Camera::resize(Size<double> newWindowSize)
+	{
+		windowSize = newWindowSize;
+		if (windowSize.width < 1) windowSize.width = 1;						// minimized window has no size, mappings would divide by 0
+		if (windowSize.height < 1) windowSize.height = 1;
+		update();
+	}
+
+
+	void Camera::pan(double moveX, double moveY)
+	{
+		viewCenter.x -= moveX / zoom;
+		viewCenter.y += moveY / zoom;
+		update();
+	}
+
+
+	void Camera::zoomAt(Point<double> pixel, double factor)
+	{
+		auto point = toModel(pixel);
+
+		zoom *= factor;
+		if (zoom < minZoom) zoom = minZoom;
+		if (zoom > maxZoom) zoom = maxZoom;
+
+		viewCenter.x = point.x - (pixel.x - windowSize.width / 2) / zoom;		// view center is chosen so the point is under the same pixel again
+		viewCenter.y = point.y + (pixel.y - windowSize.height / 2) / zoom;
+		update();
+	}
+
+
+	BoundingBox<double> Camera::visibleArea()
+	{
+		double halfWidth = windowSize.width / (2 * zoom);
+		double halfHeight = windowSize.height / (2 * zoom);
+		return BoundingBox<double>(Point<double>(viewCenter.x - halfWidth, viewCenter.y - halfHeight), Point<double>(viewCenter.x + halfWidth, viewCenter.y + halfHeight));
+	}
+
+
+	double Camera::getPixelSize() { return 1 / zoom; }
+	double Camera::getZoom() { return zoom; }
+	Point<double> Camera::getViewCenter() { return viewCenter; }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Primitives.h"
+#include "Transform.h"
+
+
+
+namespace primitives
+{
+	// Camera says which part of model is seen in window. View is kept as the model point in the middle of window and zoom (pixels
+	// per model unit), the window shows more of model when it's made bigger. Mappings are computed once after every change, so mapping
+	// a point is only multiply-add. Pixel coordinates are continuous: pixel (i, j) covers [i, i + 1) x [j, j + 1), y goes down like in glut
+	class Camera
+	{
+		Size<double> windowSize;												// in pixels
+		Point<double> viewCenter;												// model point in the middle of window
+		double zoom;															// pixels per model unit
+
+		AffineTransform modelToPixels;
+		AffineTransform pixelsToModel;											// inverse of modelToPixels, used for cursor picking
+		AffineTransform modelToScreen;											// model to gl coordinates: from -1 to 1 in both directions, y goes up
+
+		void update();															// computes mappings again
+	public:
+		static constexpr double minZoom = 1e-6;
+		static constexpr double maxZoom = 1e8;									// a quarter pixel is still above the sagitta of ArcAccuracy::maxSections for arcs as big as the original view
+
+		Camera(Size<double> windowSize, double zoom);							// view center is the model origin
+		void resize(Size<double> newWindowSize);								// zoom and view center stay, window shows more or less of model
+		void pan(double moveX, double moveY);									// moves model by given pixels, like it was dragged
+		void zoomAt(Point<double> pixel, double factor);						// zooms by factor (above 1 zooms in), the model point under pixel stays in place
+
+		inline Point<double> toModel(Point<double> pixel) { return pixelsToModel.apply(pixel); }
+		inline Point<double> toPixels(Point<double> point) { return modelToPixels.apply(point); }
+		inline AffineTransform& getModelToScreen() { return modelToScreen; }
+		BoundingBox<double> visibleArea();										// returns the part of model that is seen in window
+		double getPixelSize();													// returns length of one pixel in model units
+		double getZoom();
+		Point<double> getViewCenter();
+	};
+}
@@ -4,36 +4,13 @@
 
 namespace controler
 {
-	// Functors
-	// AddLine
-
-	bool AddLine::operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine)
-	{
-		return polyLine->addLine(point);
-	}
-
-	AddNodeFunctor* AddLine::copy() { return new AddLine(*this); }
-
-
-
-	// AddArc
-
-	bool AddArc::operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) 
-	{
-		return polyLine->addArc(point);
-	}
-
-	AddNodeFunctor* AddArc::copy()  { return new AddArc(*this); }
-	
-
-
-
 	// MainMenu
 
-	MainMenu::MainMenu(PolyLineControler* polyLineControler, HistoryHandler* historyHandler)
+	Controler* MainMenu::controler = nullptr;
+
+	MainMenu::MainMenu(Controler* controler)
 	{
-		MainMenu::polyLineControler = polyLineControler;
-		MainMenu::historyHandler = historyHandler;
+		MainMenu::controler = controler;
 	}
 
 
@@ -68,458 +45,411 @@ namespace controler
 
 	void MainMenu::chooseOption(int option)
 	{
-		switch (option)
-		{
-		case OptionName::StopDrawing:
-			polyLineControler->removePolyLine();
-			break;
-		case OptionName::Line:
-			polyLineControler->startAddingLines();
-			break;
-		case OptionName::Arc:
-			polyLineControler->startAddingArcs();
-			break;
-		case OptionName::Undo:
-			historyHandler->undo();
-			break;
-		case OptionName::Redo:
-			historyHandler->redo();
-			break;
-		}
+		if (controler)
+			controler->onMenuOption(option);
 	}
 
 
 
 
-	// PolyLineControler
-
-	PolyLineControler* MainMenu::polyLineControler = nullptr;
+	// WindowHandler
 
-	PolyLineControler::PolyLineControler(HistoryHandler& historyHandler)
-		:	currentPolyLine(),
-			addArc(),
-			addLine(),
-			addNodeFunctor(&addLine),
-			actualizeArc(),
-			actualizeLine(),
-			actualize(&actualizeLine),
-			historyHandler(historyHandler)
-	{
-		historyHandler.setPolylineControler(this);
-	}
+	WindowHandler::WindowHandler(Color& backgroundColor, Color& polyLineColor, Color& peakPointColor)
+		:	backgroundColor(backgroundColor),
+			polyLineColor(polyLineColor),
+			peakPointColor(peakPointColor)
+	{	}
 
 
-	bool PolyLineControler::startAddingArcs()
+	void WindowHandler::displayScreen(SceneSnapshot& snapshot)
 	{
-		if (!polyLineIsAttached())
-		{
-			actualize = &actualizeLine;
-			addNodeFunctor = &addLine;
-			return false;
-		}
+		glClearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, backgroundColor.a);	// background color
 
-		if (currentPolyLine->lastNodeIndex() == 0)		// if last node is first node adding arc is impossible
-		{
-			actualize = &actualizeLine;
-			addNodeFunctor = &addLine;
-			return false;			
-		}
+		glClear(GL_COLOR_BUFFER_BIT);
 
-		actualize = &actualizeArc;
-		addNodeFunctor = &addArc;
-		return true;
-	}
+		if (snapshot.document) displayDocument(*snapshot.document);
+		if (snapshot.polyLine) displayPolyLine(*snapshot.polyLine);
+		if (snapshot.preview) displayPolyLine(*snapshot.preview);
+		if (snapshot.selection) displayPeakPoints(snapshot.selection->peakPoints);
 
-	bool PolyLineControler::startAddingLines()
-	{
-		actualize = &actualizeLine;
-		addNodeFunctor = &addLine;
-		return true;
+		glFlush();
+		glutSwapBuffers();
 	}
 
-	void PolyLineControler::setArcAproximationAccuracy(unsigned int accuracy) { this->arcApproximationAccuracy = accuracy; }
-	
-	bool PolyLineControler::polyLineIsAttached()
-	{
-		return (currentPolyLine != nullptr);
-	}
 
-	void PolyLineControler::removePolyLine()
+	void WindowHandler::displayDocument(const SceneArrays& arrays)
 	{
-		startAddingLines();
-		currentPolyLine.reset();
+		if (!arrays.vertexes.empty())
+		{
+			glColor3f(polyLineColor.r, polyLineColor.g, polyLineColor.b);
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glVertexPointer(2, GL_FLOAT, 0, arrays.vertexes.data());
+			glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(arrays.vertexes.size() / 2));
+			glDisableClientState(GL_VERTEX_ARRAY);
+		}
+		displayPeakPoints(arrays.peakPoints);
 	}
 
-
-	void PolyLineControler::actualizePolyLine(Point<double>& mousePosition, WindowHandler& windowHandler)
+	
+	void WindowHandler::displayPolyLine(const SceneArrays& arrays)
 	{
-		if (polyLineIsAttached())
+		if (!arrays.vertexes.empty())
 		{
-			try
+			glColor3f(polyLineColor.r, polyLineColor.g, polyLineColor.b);
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glVertexPointer(2, GL_FLOAT, 0, arrays.vertexes.data());
+			size_t stripBegin = 0;
+			for (auto stripEnd : arrays.stripEnds)								// visible parts of polyline are separate strips
 			{
-				currentPolyLine->unBlockDisplayNode();
-				(*actualize)(mousePosition, currentPolyLine);
+				glDrawArrays(GL_LINE_STRIP, static_cast<GLint>(stripBegin), static_cast<GLsizei>(stripEnd - stripBegin));
+				stripBegin = stripEnd;
 			}
-			catch(...)
-			{ }
+			glDisableClientState(GL_VERTEX_ARRAY);
 		}
+		displayPeakPoints(arrays.peakPoints);
 	}
 
 
-	void PolyLineControler::addNode(Point<double>& point)
+	void WindowHandler::displayPeakPoints(const vector<float>& points)
 	{
-		if (polyLineIsAttached())
-		{
-			currentPolyLine->blockDisplayNode();
-			auto newEvent = Event(point, *addNodeFunctor);
-			currentPolyLine->blockDisplayNode();
-			(*addNodeFunctor)(point, currentPolyLine);
-			historyHandler.addEvent(newEvent);
+		if (points.empty()) return;
 
-		}
-		else
-		{
-			auto newPolyline = make_unique<PolyLine>(point);
-			currentPolyLine.swap(newPolyline);					// current polyline is set to just created newPolyline
-		}
+		glColor3f(peakPointColor.r, peakPointColor.g, peakPointColor.b);
+		glPointSize(5);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(2, GL_FLOAT, 0, points.data());
+		glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(points.size() / 2));
+		glDisableClientState(GL_VERTEX_ARRAY);
 	}
 
 
-	void PolyLineControler::redoNode(AddNodeFunctor& addNode, Point<double>& point)
-	{
-		if (polyLineIsAttached())
-		{
-			addNode(point, currentPolyLine);
-		}
-		else
-		{
-			auto newPolyline = make_unique<PolyLine>(point);
-			currentPolyLine.swap(newPolyline);					// current polyline is set to just created newPolyline
-		}
-	}
 
 
-	void PolyLineControler::removeNode()
-	{
-		if (polyLineIsAttached())
-		{
-			bool nodeRemoved = currentPolyLine->removeLastNode();
 
-			if(!nodeRemoved)
-				currentPolyLine.reset(nullptr);					// if there's only one node left, the whole polyline is going to be removed
-		}
-	}
+	// FrameScheduler
 
+	FrameScheduler* FrameScheduler::scheduler = nullptr;
 
-	void PolyLineControler::generateVertexChain(VertexChain<double>& vertexChain)
+	FrameScheduler::FrameScheduler(unsigned int maxFramesPerSecond)
+		:	minFrameInterval((maxFramesPerSecond == 0) ? 0 : (1000 + maxFramesPerSecond - 1) / maxFramesPerSecond)
 	{
-		if (polyLineIsAttached())
-			currentPolyLine->generateVertexChain(vertexChain, arcApproximationAccuracy);
+		FrameScheduler::scheduler = this;
 	}
 
 
-	void PolyLineControler::generatePeakPoints(vector<Point<double>>& peakPoints)
+	FrameScheduler::~FrameScheduler()
 	{
-		if (polyLineIsAttached())
-			currentPolyLine->generatePeakPoints(peakPoints);
+		FrameScheduler::scheduler = nullptr;
 	}
 
 
-
-
-	// Event
-	
-	Event::Event(Point<double>& point, AddNodeFunctor& addFunctor)
-		:	point(point),
-			addNodeFunctor()
-	{	
-		addNodeFunctor = unique_ptr<AddNodeFunctor>(addFunctor.copy());
-	}
-
-
-	Event::Event(const Event& eventToCopy )
-		:	point(eventToCopy.point)
+	void FrameScheduler::invalidate()
 	{
-		addNodeFunctor = unique_ptr<AddNodeFunctor>(eventToCopy.addNodeFunctor->copy());
-	}
-
+		if (frameRequested) return;							// the frame that is already requested shows this change too
+		frameRequested = true;
 
-	Event& Event::operator=(const Event&  eventToCopy)
-	{
-		addNodeFunctor = unique_ptr<AddNodeFunctor>(eventToCopy.addNodeFunctor->copy());
-		return *this;
+		int elapsed = glutGet(GLUT_ELAPSED_TIME) - lastFrameTime;
+		if ((minFrameInterval == 0) || (elapsed >= (int)minFrameInterval))
+			glutPostRedisplay();
+		else
+			glutTimerFunc(minFrameInterval - elapsed, FrameScheduler::onTimerFunction, 0);
 	}
 
 
-	void Event::undo(PolyLineControler& polyLineControler)
+	void FrameScheduler::frameDisplayed()
 	{
-		polyLineControler.removeNode();
+		frameRequested = false;
+		lastFrameTime = glutGet(GLUT_ELAPSED_TIME);
 	}
 
 
-	void Event::redo(PolyLineControler& polyLineControler)
+	void FrameScheduler::onTimerFunction(int)
 	{
-		polyLineControler.redoNode(*addNodeFunctor, point);
+		if (scheduler)
+			glutPostRedisplay();
 	}
 
 
 
-	// History Handler
-
-	HistoryHandler* MainMenu::historyHandler = nullptr;
 
-	
-	HistoryHandler::HistoryHandler()
-		:	events()
-	{	}
+	// Controler
 
-	
-	void HistoryHandler::setPolylineControler(PolyLineControler* polyLineContrl) { polyLineControler = polyLineContrl; }
+	Controler* Controler::appControler = nullptr;
 
-	
-	bool HistoryHandler::canUndo()
+	Controler::Controler(Size<unsigned int>& windowSize, string& windowTitle, Color& backgroundColor, Color& polyLineColor, Color& peakPointColor)
+		:	windowHandler(backgroundColor, polyLineColor, peakPointColor),
+			frameScheduler(maxFramesPerSecond),
+			menu(this),
+			camera(Size<double>(windowSize.width, windowSize.height), windowSize.height / 2.0),	// model is 2 units high in the original window
+			historyHandler(),
+			document(),
+			polyLineControler(historyHandler, document)
 	{
-		return (currentEventIndex >= 0);
-	}
+		Controler::appControler = this;
 
-	
-	bool HistoryHandler::canRedo()
-	{
-		int lastEventIndex = events.size() - 1;
-		return (currentEventIndex != lastEventIndex);
+		glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
+		glutInitWindowSize(windowSize.width, windowSize.height);
+		glutCreateWindow(windowTitle.c_str());
+		initializeGlutCallbacks();
+		menu.initializeMenu();
+		polyLineControler.setArcMaxScreenDeviation(arcMaxScreenDeviation, camera.getPixelSize());
+		editingThread = std::thread(&Controler::editingLoop, this);
 	}
 
-	
-	void HistoryHandler::undo()
+
+	void Controler::initializeGlutCallbacks()
 	{
-		if (canUndo())
-		{
-			Event& currentEvent = events[currentEventIndex];
-			currentEvent.undo(*polyLineControler);
-			currentEventIndex--;
-		}
+		glutDisplayFunc(getDisplayFunction());					// there's no idle function, screen is displayed only after changes (see FrameScheduler)
+		glutReshapeFunc(getWindowResizeCallback());
+		glutPassiveMotionFunc(getOnMouseMoveCallback());
+		glutMotionFunc(getOnMouseDragCallback());
+		glutMouseFunc(getOnMouseClickCallback()); 
 	}
 
-	
-	void HistoryHandler::redo()
+
+	Controler::~Controler()
 	{
-		if (canRedo())
 		{
-			currentEventIndex++;
-			Event& currentEvent = events[currentEventIndex];
-			currentEvent.redo(*polyLineControler);
+			std::lock_guard<std::mutex> lock(eventsMutex);
+			stopping = true;
 		}
+		eventPosted.notify_one();
+		editingThread.join();
+		Controler::appControler = nullptr;
 	}
 
-	
-	void HistoryHandler::addEvent(Event& currentEvent)
-	{
-		events.push_back(currentEvent);
-		currentEventIndex++;
-
-		int newSize = currentEventIndex + 1;
-		events.resize(newSize);
-	}
-
-
-
 
-	// WindowHandler
 
-	WindowHandler::WindowHandler(Size<unsigned int>& windowSize, Color& backgroundColor, Color& polyLineColor, Color& peakPointColor)
-		:	windowSize(windowSize.width, windowSize.height),
-			windowOrginalSize((double)windowSize.width, (double)windowSize.height),
-			centerOfScreen(windowSize.width / 2, windowSize.width / 2),
-			backgroundColor(backgroundColor),
-			polyLineColor(polyLineColor),
-			peakPointColor(peakPointColor)
-	{	}
 
+	// editing thread
 
-	void WindowHandler::translateVertexChain(VertexChain<double>& vertexChain)
+	void Controler::postEvent(InputEvent event)
 	{
-		auto& vertexes = vertexChain.getVertexes();
-		for (auto& vertex : vertexes)
-			translateModelToScreen(vertex);
+		{
+			std::lock_guard<std::mutex> lock(eventsMutex);
+			if ((event.kind == InputEvent::MouseMove) && (!postedEvents.empty()) && (postedEvents.back().kind == InputEvent::MouseMove))
+				postedEvents.back() = event;						// only the last position of cursor is shown
+			else
+				postedEvents.push_back(event);
+			postedEventsCount++;
+		}
+		eventPosted.notify_one();
+		frameScheduler.invalidate();
 	}
 
 
-	void WindowHandler::tanslateSetOfPoints(vector<Point<double>>& points)
+	void Controler::editingLoop()
 	{
-		for (auto& point : points)
-			translateModelToScreen(point);
+		std::unique_lock<std::mutex> lock(eventsMutex);
+		while (true)
+		{
+			eventPosted.wait(lock, [this] { return stopping || !postedEvents.empty(); });
+			if (stopping) return;
+			takenEvents.swap(postedEvents);						// glut thread posts the next events while these are applied
+			auto takenEventsCount = postedEventsCount;
+			lock.unlock();
+
+			for (auto& event : takenEvents)
+				applyEvent(event);
+			takenEvents.clear();
+			sceneBuilder.publish(polyLineControler, camera);
+			publishedEventsCount.store(takenEventsCount, std::memory_order_release);
+
+			lock.lock();
+		}
 	}
 
 
-	void WindowHandler::translateModelToScreen(Point<double>& point)
+	void Controler::applyEvent(InputEvent& event)
 	{
-		point.x = windowOrginalSize.height / windowSize.width * point.x;	// its windowOrginalSize.height because height is the reference value if the oryginal screen size is not 1:1
-		point.y = windowOrginalSize.height / windowSize.height * point.y;
+		switch (event.kind)
+		{
+		case InputEvent::MouseMove:
+			{
+				auto mousePositionMapped = cursorToModel(event.position);
+				polyLineControler.actualizePolyLine(mousePositionMapped);
+			}
+			break;
+		case InputEvent::Click:
+			{
+				auto mousePositionMapped = cursorToModel(event.position);
+				polyLineControler.addNode(mousePositionMapped);
+			}
+			break;
+		case InputEvent::SelectClick:
+			{
+				auto mousePositionMapped = camera.toModel(Point<double>(event.position.x + 0.5, event.position.y + 0.5));
+				polyLineControler.selectNode(mousePositionMapped, snapRadius * camera.getPixelSize());
+			}
+			break;
+		case InputEvent::Zoom:
+			camera.zoomAt(Point<double>(event.position.x + 0.5, event.position.y + 0.5), (event.value != 0) ? zoomStep : 1 / zoomStep);
+			viewChanged();
+			break;
+		case InputEvent::Pan:
+			camera.pan(event.position.x, event.position.y);		// only view is changed, arrays are made again once for the next snapshot
+			sceneBuilder.invalidate();
+			break;
+		case InputEvent::Resize:
+			camera.resize(Size<double>(event.position.x, event.position.y));
+			viewChanged();
+			break;
+		case InputEvent::MenuOption:
+			applyMenuOption(event.value);
+			break;
+		}
 	}
 
 
-	Point<double> WindowHandler::translateToModel(Point<unsigned int>& cursorPosition)
+	void Controler::applyMenuOption(int option)
 	{
-		double x = static_cast<double>(cursorPosition.x);
-		double y = static_cast<double>(cursorPosition.y);
-
-		x -= centerOfScreen.x;
-		y -= centerOfScreen.y;
-
-		x *= 1 / centerOfScreen.x;;
-		y *= -1 / centerOfScreen.y;
-
-		x *= (windowSize.width - windowSize.width / 2) / (windowOrginalSize.height - windowOrginalSize.height / 2);	// its windowOrginalSize.height because height is the reference value if the oryginal screen size is not 1:1
-		y *= (windowSize.height - windowSize.height / 2) / (windowOrginalSize.height - windowOrginalSize.height / 2);
-
-		return Point<double>(x, y);
+		switch (option)
+		{
+		case MainMenu::StopDrawing:
+			polyLineControler.removePolyLine();
+			break;
+		case MainMenu::Line:
+			polyLineControler.startAddingLines();
+			break;
+		case MainMenu::Arc:
+			polyLineControler.startAddingArcs();
+			break;
+		case MainMenu::Undo:
+			historyHandler.undo();
+			break;
+		case MainMenu::Redo:
+			historyHandler.redo();
+			break;
+		case MainMenu::Snap:
+			polyLineControler.switchSnapping();
+			break;
+		}
 	}
 
 
-	void WindowHandler::displayScreen(PolyLineControler& polyLineControler)
+	Point<double> Controler::cursorToModel(Point<int>& mousePosition)
 	{
-		glClearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, backgroundColor.a);	// background color
-
-		glClear(GL_COLOR_BUFFER_BIT);
+		auto pixel = Point<double>(mousePosition.x + 0.5, mousePosition.y + 0.5);	// cursor points at the middle of pixel
+		auto mousePositionMapped = camera.toModel(pixel);
+		return polyLineControler.snap(mousePositionMapped, snapRadius * camera.getPixelSize());
+	}
 
-		displayVertexes(polyLineControler);
-		displayPeakPoints(polyLineControler);
 
-		glFlush();
-		glutSwapBuffers();
+	void Controler::viewChanged()
+	{
+		polyLineControler.setArcMaxScreenDeviation(arcMaxScreenDeviation, camera.getPixelSize());
+		sceneBuilder.invalidate();
 	}
 
-	
-	void WindowHandler::displayVertexes(PolyLineControler& polyLineControler)
-	{
-		VertexChain<double> vertexChain;
-		polyLineControler.generateVertexChain(vertexChain);
-		translateVertexChain(vertexChain);
 
-		auto vertexes = vertexChain.getVertexes();
 
-		glColor3f(polyLineColor.r, polyLineColor.g, polyLineColor.b);
-		glBegin(GL_LINE_STRIP);
 
-		for (auto vertex : vertexes)
-			glVertex2d(vertex.x, vertex.y);
+	// On Mouse Move event
 
-		glEnd();
+	onMouseMoveCallback Controler::getOnMouseMoveCallback()
+	{
+		return Controler::onMouseMoveFunction;
 	}
 
 
-	void WindowHandler::displayPeakPoints(PolyLineControler& polyLineControler)
+	void Controler::onMouseMoveFunction(int x, int y)
 	{
-		vector<Point<double>> peakPoints;
-		polyLineControler.generatePeakPoints(peakPoints);
-		tanslateSetOfPoints(peakPoints);
-
-		glColor3f(peakPointColor.r, peakPointColor.g, peakPointColor.b);
-		glPointSize(5);
-		glBegin(GL_POINTS);
-
-		for (auto point : peakPoints)
-			glVertex2d(point.x, point.y);
-
-		glEnd();
+		auto mousePoistion = Point<unsigned int>(x, y);
+		if(Controler::appControler != nullptr)
+			appControler->onMouseMove(mousePoistion);
 	}
 
 
-	void WindowHandler::resize(Size<int>& newSize)
+	void Controler::onMouseMove(Point<unsigned int>& mousePosition)
 	{
-		windowSize = newSize;
-		centerOfScreen.x = newSize.width / 2;
-		centerOfScreen.y = newSize.height / 2;
+		postEvent({ InputEvent::MouseMove, Point<int>(mousePosition.x, mousePosition.y), 0 });
 	}
 
 
+	// On Mouse Click event
 
+	onMouseClickCallback Controler::getOnMouseClickCallback()
+	{
+		return Controler::onMouseClickFunction;
+	}
 
-
-	// Controler
-
-	Controler* Controler::appControler = nullptr;
-
-	Controler::Controler(Size<unsigned int>& windowSize, string& windowTitle, Color& backgroundColor, Color& polyLineColor, Color& peakPointColor)
-		:	historyHandler(),
-			polyLineControler(historyHandler),
-			windowHandler(windowSize, backgroundColor, polyLineColor, peakPointColor),
-			menu(&polyLineControler, &historyHandler)
+	void Controler::onMouseClickFunction(int button, int state, int x, int y)
 	{
-		Controler::appControler = this;
+		auto mousePosition = Point<unsigned int>(x, y);
 
-		glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
-		glutInitWindowSize(windowSize.width, windowSize.height);
-		glutCreateWindow(windowTitle.c_str());
-		initializeGlutCallbacks();
-		menu.initializeMenu();
+		if (appControler != nullptr)
+		{
+			if ((button == GLUT_LEFT_BUTTON) && (state == GLUT_DOWN) && ((glutGetModifiers() & GLUT_ACTIVE_CTRL) != 0))
+				appControler->onSelectClick(mousePosition);
+			else if ((button == GLUT_LEFT_BUTTON) && (state == GLUT_DOWN))
+				appControler->onMouseClick(mousePosition);
+			else if (button == GLUT_MIDDLE_BUTTON)
+			{
+				auto cursorPosition = Point<int>(x, y);
+				appControler->onMiddleButton(cursorPosition, state == GLUT_DOWN);
+			}
+			else if (((button == 3) || (button == 4)) && (state == GLUT_DOWN))		// freeglut reports mouse wheel as buttons 3 (up) and 4 (down)
+				appControler->onMouseWheel(mousePosition, button == 3);
+		}
 	}
 
-
-	void Controler::initializeGlutCallbacks()
+	void Controler::onMouseClick(Point<unsigned int>& mousePosition)
 	{
-		glutDisplayFunc(getDisplayFunction());
-		glutIdleFunc(getDisplayFunction());
-		glutReshapeFunc(getWindowResizeCallback());
-		glutPassiveMotionFunc(getOnMouseMoveCallback());
-		glutMouseFunc(getOnMouseClickCallback()); 
+		postEvent({ InputEvent::Click, Point<int>(mousePosition.x, mousePosition.y), 0 });
 	}
 
 
-	Controler::~Controler()
+	void Controler::onSelectClick(Point<unsigned int>& mousePosition)
 	{
-		Controler::appControler = nullptr;
+		postEvent({ InputEvent::SelectClick, Point<int>(mousePosition.x, mousePosition.y), 0 });
 	}
 
 
-
-
-	// On Mouse Move event
-
-	onMouseMoveCallback Controler::getOnMouseMoveCallback()
+	void Controler::onMiddleButton(Point<int>& mousePosition, bool pressed)
 	{
-		return Controler::onMouseMoveFunction;
+		panning = pressed;
+		panPosition = mousePosition;
 	}
 
-
-	void Controler::onMouseMoveFunction(int x, int y)
+	void Controler::onMouseWheel(Point<unsigned int>& mousePosition, bool zoomIn)
 	{
-		auto mousePoistion = Point<unsigned int>(x, y);
-		if(Controler::appControler != nullptr)
-			appControler->onMouseMove(mousePoistion);
+		postEvent({ InputEvent::Zoom, Point<int>(mousePosition.x, mousePosition.y), zoomIn ? 1 : 0 });
+		onMouseMove(mousePosition);
 	}
 
 
-	void Controler::onMouseMove(Point<unsigned int>& mousePosition)
+
+
+	// On Mouse Drag event (mouse moves with pressed button)
+
+	onMouseMoveCallback Controler::getOnMouseDragCallback()
 	{
-		auto mousePositionMapped = windowHandler.translateToModel(mousePosition);
-		polyLineControler.actualizePolyLine(mousePositionMapped, windowHandler);
+		return Controler::onMouseDragFunction;
 	}
 
 
-	// On Mouse Click event
-
-	onMouseClickCallback Controler::getOnMouseClickCallback()
+	void Controler::onMouseDragFunction(int x, int y)
 	{
-		return Controler::onMouseClickFunction;
+		auto mousePosition = Point<int>(x, y);
+		if (Controler::appControler != nullptr)
+			appControler->onMouseDrag(mousePosition);
 	}
 
-	void Controler::onMouseClickFunction(int button, int state, int x, int y)
+
+	void Controler::onMouseDrag(Point<int>& mousePosition)
 	{
-		auto mousePosition = Point<unsigned int>(x, y);
+		if (!panning) return;
 
-		if (appControler != nullptr)
+		postEvent({ InputEvent::Pan, Point<int>(mousePosition.x - panPosition.x, mousePosition.y - panPosition.y), 0 });
+		panPosition = mousePosition;
+		if ((mousePosition.x >= 0) && (mousePosition.y >= 0))			// cursor can leave the window while dragging
 		{
-			if ((button == GLUT_LEFT_BUTTON) && (state == GLUT_DOWN))
-				appControler->onMouseClick(mousePosition);
+			auto cursorPosition = Point<unsigned int>(mousePosition.x, mousePosition.y);
+			onMouseMove(cursorPosition);
 		}
 	}
 
-	void Controler::onMouseClick(Point<unsigned int>& mousePosition)
-	{
-		auto mousePositionMapped = windowHandler.translateToModel(mousePosition);
-		polyLineControler.addNode(mousePositionMapped);	
-	}
+
 
 
 	// display event
@@ -532,7 +462,14 @@ namespace controler
 	void Controler::displayFunction()
 	{
 		if (appControler)
-			appControler->windowHandler.displayScreen(appControler->polyLineControler);
+		{
+			bool allEventsShown = appControler->publishedEventsCount.load(std::memory_order_acquire) == appControler->postedEventsCount;
+			auto& snapshot = appControler->sceneBuilder.takeLatest();	// count is read first, so the taken snapshot shows at least those events
+			appControler->frameScheduler.frameDisplayed();
+			appControler->windowHandler.displayScreen(snapshot);
+			if (!allEventsShown)									// editing thread hasn't published the last events yet, the next frame shows them
+				appControler->frameScheduler.invalidate();
+		}
 	}
 	
 
@@ -555,13 +492,18 @@ namespace controler
 			glutSwapBuffers();
 			auto newWindowSize = Size<int>(width, height);
 			appControler->onResize(newWindowSize);
-			displayFunction();
 		}
 	}
 
 
 	void Controler::onResize(Size<int>& newSize)
 	{
-		windowHandler.resize(newSize);
+		postEvent({ InputEvent::Resize, Point<int>(newSize.width, newSize.height), 0 });
+	}
+
+
+	void Controler::onMenuOption(int option)
+	{
+		postEvent({ InputEvent::MenuOption, Point<int>(0, 0), option });
 	}
 }
\ No newline at end of file
@@ -1,9 +1,17 @@
 #pragma once
 #include "Primitives.h"
+#include "Camera.h"
 #include "Polyline.h"
+#include "PolylineControler.h"
+#include "Scene.h"
+#include "Transform.h"
 #include "glut.h"
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 
 namespace primitives
@@ -33,63 +41,11 @@ namespace controler
 	class WindowHandler;
 	class PolyLineControler;
 	class HistoryHandler;
+	class FrameScheduler;
+	class Controler;
 
 
 
-	// this functors is called when its needed to edit polyline. It's used for plain edition as well as for "undo" "redo" operations
-	struct AddNodeFunctor
-	{
-		virtual bool operator()(Point<double>&, unique_ptr<PolyLine>&) = 0;
-		virtual AddNodeFunctor* copy() = 0;
-		virtual ~AddNodeFunctor() = default;
-	};
-
-	struct AddLine
-		: public AddNodeFunctor
-	{
-		AddLine() = default;
-		~AddLine() = default;
-		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) override;
-		AddNodeFunctor* copy() override;
-	};
-
-	struct AddArc
-		: public AddNodeFunctor
-	{
-		AddArc() = default;
-		~AddArc() = default;
-		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) override;
-		AddNodeFunctor* copy() override;
-	};
-
-	// below functors are called when it's need to actualize the shape of polyline
-	struct Actualize
-	{
-		virtual bool operator()(Point<double>&, unique_ptr<PolyLine>&) = 0;
-	};
-
-	struct ActualizeLine
-		: public Actualize
-	{
-		ActualizeLine() = default;
-		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) override
-		{
-			return polyLine->addDisplayLineNode(point);
-		}
-	};
-
-	struct ActualizArc
-		: public Actualize
-	{
-		ActualizArc() = default;
-		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) override
-		{
-			return polyLine->addDisplayArcNode(point);
-		}
-	};
-	
-
-
 	struct Option
 	{
 		int index;
@@ -100,8 +56,7 @@ namespace controler
 
 	class MainMenu
 	{
-		static PolyLineControler* polyLineControler;
-		static HistoryHandler* historyHandler;
+		static Controler* controler;
 
 		vector<Option> options
 		{
@@ -109,7 +64,8 @@ namespace controler
 			{Line, "Line", true},
 			{Arc, "Arc", false},
 			{Undo, "Undo", false},
-			{Redo, "Redo", false}
+			{Redo, "Redo", false},
+			{Snap, "Snap on/off", true}
 		};
 
 	public:
@@ -120,116 +76,86 @@ namespace controler
 			Line,
 			Arc,
 			Undo,
-			Redo
+			Redo,
+			Snap
 		};
 
-		MainMenu(PolyLineControler* polyLineControler, HistoryHandler* historyHandler);
+		MainMenu(Controler* controler);
 		void initializeMenu();																// sets options in main menu
 		void disableOption(OptionName option);												// disables option
 		void enableOption(OptionName option);												// enables option
-		static void chooseOption(int option);												// static method that is called by OpenGl after peaking menu option
-	};
-
-
-
-
-	class Event
-	{
-		unique_ptr<AddNodeFunctor> addNodeFunctor;
-		Point<double> point;
-	public:
-		Event() = default;
-		~Event() = default;
-		Event(const Event&);
-		Event& operator=(const Event& ) ;
-		Event(Point<double>& point, AddNodeFunctor& addFunctor);
-		void undo(PolyLineControler& polyLineControler);									// removes the last node
-		void redo(PolyLineControler& polyLineControler);									// calls functor that was used for creating node that's wanted to be appear again
+		static void chooseOption(int option);												// static method that is called by OpenGl after peaking menu option, passes it to editing thread
 	};
 
 
 
 
-	class HistoryHandler
+	// WindowHandler displays snapshots of the scene (see SceneBuilder) on glut thread. It never reads polylines or camera, so displaying
+	// doesn't depend on what the editing thread is doing
+	class WindowHandler
 	{
-		PolyLineControler* polyLineControler;
-		vector<Event> events;
-		int currentEventIndex = -1;
+		Color backgroundColor;
+		Color polyLineColor;
+		Color peakPointColor;
 
+		void displayDocument(const SceneArrays& arrays);						// displays finished polylines with their peak points
+		void displayPolyLine(const SceneArrays& arrays);						// displays polyline being drawn (line strips)
+		void displayPeakPoints(const vector<float>& points);					// displays peak points of arcs
 	public:
-		HistoryHandler();
-		bool canUndo();													// returns true when undo operation is possible
-		bool canRedo();													// returns true when redo operation is possible
-		void undo();													// if possible calls undo method in current functor
-		void redo();													// if possible calls redo method in current functor
-		void addEvent(Event& currentEvent);								// adds event to collection, so it could be called again, when it's need to reuse it (redo operations)
-		inline void setPolylineControler(PolyLineControler*);			// sets polyLineControler pointer
+		WindowHandler(Color& backgroundColor, Color& polyLineColor, Color& peakPointColor);
+		void displayScreen(SceneSnapshot& snapshot);							// displays snapshot to the screen
 	};
 
 
 
 
+	
 
-
-	class PolyLineControler
+	// FrameScheduler decides when the screen is displayed again. Nothing is drawn while nothing changes; every change invalidates the scene
+	// and many invalidations before the next frame give only one frame. Frames can be limited, then a late frame waits for glut timer
+	class FrameScheduler
 	{
-		AddLine addLine;
-		AddArc addArc;
-		AddNodeFunctor* addNodeFunctor;							// it points to addLine or addArc, depending on what type of node is wanted to be add
-
-		ActualizeLine actualizeLine;
-		ActualizArc actualizeArc;
-		Actualize* actualize;									// it points to actualizeArc or actualizeLine. These functors are adding display node to polyline
+		static FrameScheduler* scheduler;						// used by glut timer callback
+		static void onTimerFunction(int);
 
-		HistoryHandler& historyHandler;
-		unique_ptr<PolyLine> currentPolyLine;
-		unsigned int arcApproximationAccuracy = 64;				// approximation of arc. It's a number of vertxes in polygon that imitates an arc. If it's set to ex. 100, there would be 100 sections around whole 360 degree arc
+		unsigned int minFrameInterval;							// in milliseconds, 0 when frames aren't limited
+		int lastFrameTime = 0;
+		bool frameRequested = false;							// redisplay or timer has been posted already, so next invalidations wait for the same frame
 
-		inline bool polyLineIsAttached();						// returns true when some polyline is attached to the class
 	public:
-		PolyLineControler(HistoryHandler& historyHandl);
-		void removePolyLine();
-		bool startAddingArcs();																	// sets addNodeFunctor for arcs
-		bool startAddingLines();																// sets addNodeFunctor for lines
-		void addNode(Point<double>& point);	
-		void redoNode(AddNodeFunctor& addNode, Point<double>& point);							// called on redo event
-		void removeNode();
-		void actualizePolyLine(Point<double>& mousePosition, WindowHandler& windowHandler);		// sets the shape of polyline so it can be displayed
-		void generateVertexChain(VertexChain<double>& vertexChain);								// generates the "multi xertex line" that would be displayed on screen
-		void generatePeakPoints(vector<Point<double>>& peakPoints);								// generates dots on peek of every arc
-		inline void setArcAproximationAccuracy(unsigned int accuracy);
+		FrameScheduler(unsigned int maxFramesPerSecond);		// 0 means that frames aren't limited
+		~FrameScheduler();
+		void invalidate();										// marks scene as changed, so it's displayed as soon as the limit lets
+		void frameDisplayed();									// called by display event, the next invalidation requests a new frame
 	};
 
 
 
 
 
-
-	class WindowHandler
+	// InputEvent is one glut event that glut thread passes to editing thread. Passive mouse moves that come one after another are merged
+	// into the last one, like glut would merge them when the thread is busy
+	struct InputEvent
 	{
-		Size<const double> windowOrginalSize;
-		Size<int> windowSize;
-		Point<double> centerOfScreen;											// it's double not int, because odd numbers would give incorrect result
-		Color backgroundColor;
-		Color polyLineColor;
-		Color peakPointColor;
-		
-		inline void translateModelToScreen(Point<double>& point);				// translates model coordinates to screen coordinates
-		void translateVertexChain(VertexChain<double>& vertexChain);			// translates model coordinates to screen coordinates
-		void tanslateSetOfPoints(vector<Point<double>>& points);				// translates model coordinates to screen coordinates
-		void displayVertexes(PolyLineControler& polyLineControler);				// displays collected vertexes (shape of polyline)
-		void displayPeakPoints(PolyLineControler& polyLineControler);			// displays collected peak points of polylines arcs on screen
-	public:
-		WindowHandler(Size<unsigned int>& windowSize, Color& backgroundColor, Color& polyLineColor, Color& peakPointColor);
-		inline void resize(Size<int>& newSize);									// resets class fields after the window resize event
-		void displayScreen(PolyLineControler& polyLineControler);				// displays model to the screen
-		Point<double> translateToModel(Point<unsigned int>& cursorPosition);	// translates cursor position to model coordinates
+		enum Kind
+		{
+			MouseMove,
+			Click,
+			SelectClick,
+			Zoom,
+			Pan,
+			Resize,
+			MenuOption
+		};
+
+		Kind kind;
+		Point<int> position;									// cursor, pan move or new window size in pixels
+		int value;												// menu option, 1 for zoom in and 0 for zoom out
 	};
 
 
 
 
-	
 
 	typedef void(*onMouseMoveCallback)(int, int);
 	typedef void(*onMouseClickCallback)(int, int, int, int);
@@ -237,6 +163,9 @@ namespace controler
 	typedef void(*menuOptionCallback)(int);
 	typedef void(*onWindowResizeCallback)(int, int);
 
+	// Controler connects glut with the editor on two threads. Glut thread takes events, passes them to editing thread and displays the newest
+	// published snapshot of the scene. Editing thread owns camera and polylines: it applies events and publishes snapshot after every batch
+	// of them, so tessellation and transforms never run on glut thread and a slow snapshot doesn't delay clicks
 	class Controler
 	{
 		// static members for openGl events handling
@@ -248,18 +177,55 @@ namespace controler
 
 		static void onMouseClickFunction(int button, int state, int x, int y);
 		void onMouseClick(Point<unsigned int>& mousePosition);
+		void onSelectClick(Point<unsigned int>& mousePosition);			// click with ctrl selects the node under cursor
+		void onMiddleButton(Point<int>& mousePosition, bool pressed);		// middle button drags the view
+		void onMouseWheel(Point<unsigned int>& mousePosition, bool zoomIn);
+
+		static void onMouseDragFunction(int x, int y);
+		void onMouseDrag(Point<int>& mousePosition);
 
 		static void onWindowResizeFunction(int width, int height);
 		void onResize(Size<int>& newWindowSize);
 
+		void onMenuOption(int option);
+		friend class MainMenu;
+
 		static void displayFunction();
 		inline void initializeGlutCallbacks();
 		// end of layer
 
-		WindowHandler windowHandler;
+		const double arcMaxScreenDeviation = 0.25;				// the biggest distance in pixels between displayed arc and the real one
+		const unsigned int maxFramesPerSecond = 60;				// the limit of displayed frames, 0 turns it off
+		const double zoomStep = 1.25;							// zoom factor of one mouse wheel step
+		const double snapRadius = 8;							// cursor snaps to node points closer than this (pixels)
+
+		WindowHandler windowHandler;							// glut thread
+		FrameScheduler frameScheduler;
+		MainMenu menu;
+		bool panning = false;									// middle button is pressed, mouse moves drag the view
+		Point<int> panPosition;									// the last cursor position while panning
+
+		Camera camera;											// editing thread: maps model to window and back
 		HistoryHandler historyHandler;
+		Document document;
 		PolyLineControler polyLineControler;
-		MainMenu menu;
+		SceneBuilder sceneBuilder;								// published on editing thread, taken by display on glut thread
+
+		std::mutex eventsMutex;									// guards postedEvents, postedEventsCount and stopping
+		std::condition_variable eventPosted;
+		vector<InputEvent> postedEvents;						// waiting for editing thread
+		vector<InputEvent> takenEvents;							// being applied by editing thread
+		unsigned long postedEventsCount = 0;					// rises with every event, merged mouse moves too
+		std::atomic<unsigned long> publishedEventsCount{ 0 };	// events that are already in published snapshots
+		bool stopping = false;
+		std::thread editingThread;								// started last, when everything it uses is made
+
+		void postEvent(InputEvent event);						// glut thread: passes event to editing thread and requests the frame that shows it
+		void editingLoop();										// editing thread: waits for events, applies them and publishes the snapshot
+		void applyEvent(InputEvent& event);
+		void applyMenuOption(int option);
+		void viewChanged();										// arcs get sections for the new pixel size and scene is made again
+		Point<double> cursorToModel(Point<int>& mousePosition);	// maps cursor to model, snapped when snapping is on
 
 	public:
 		Controler(Size<unsigned int>& windowSize, string& windowTitle, Color& backgroundColor, Color& polyLineColor, Color& peakPointColor);
@@ -267,6 +233,7 @@ namespace controler
 
 		displayCallback getDisplayFunction();					// getters for openGl mathods. Returns funtion pointers for methods handling openGl events
 		onMouseMoveCallback getOnMouseMoveCallback();		
+		onMouseMoveCallback getOnMouseDragCallback();
 		onMouseClickCallback getOnMouseClickCallback();
 		onWindowResizeCallback getWindowResizeCallback();
 	};	
@@ -0,0 +1,131 @@
+#include "Document.h"
+#include <algorithm>
+
+
+
+namespace obj
+{
+	// SpatialGrid
+
+	SpatialGrid::SpatialGrid(double cellSize)
+		:	cellSize(cellSize),
+			cells(&cellMemory)
+	{	}
+
+
+	int64_t SpatialGrid::cellCoordinate(double value)
+	{
+		const double limit = 1 << 28;								// cell coordinates have to fit in half of the key, far away boxes share border cells
+		double coordinate = std::floor(value / cellSize);
+		if (coordinate < -limit) coordinate = -limit;
+		if (coordinate > limit) coordinate = limit;
+		return static_cast<int64_t>(coordinate);
+	}
+
+
+	uint64_t SpatialGrid::cellKey(int64_t x, int64_t y)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+
+	uint32_t SpatialGrid::insert(BoundingBox<double> box)
+	{
+		auto id = static_cast<uint32_t>(boxes.size());
+		boxes.push_back(box);
+		visitMarks.push_back(0);
+		if (box.isEmpty()) return id;
+
+		int64_t minX = cellCoordinate(box.minPoint.x);
+		int64_t minY = cellCoordinate(box.minPoint.y);
+		int64_t maxX = cellCoordinate(box.maxPoint.x);
+		int64_t maxY = cellCoordinate(box.maxPoint.y);
+		if (static_cast<uint64_t>(maxX - minX + 1) * static_cast<uint64_t>(maxY - minY + 1) > maxCellsPerItem)
+		{
+			largeItems.push_back(id);
+			return id;
+		}
+
+		for (int64_t x = minX; x <= maxX; x++)
+			for (int64_t y = minY; y <= maxY; y++)
+				cells[cellKey(x, y)].push_back(id);
+		return id;
+	}
+
+
+	void SpatialGrid::query(BoundingBox<double> area, vector<uint32_t>& ids)
+	{
+		if (area.isEmpty()) return;
+		size_t firstFound = ids.size();
+
+		int64_t minX = cellCoordinate(area.minPoint.x);
+		int64_t minY = cellCoordinate(area.minPoint.y);
+		int64_t maxX = cellCoordinate(area.maxPoint.x);
+		int64_t maxY = cellCoordinate(area.maxPoint.y);
+		if (static_cast<uint64_t>(maxX - minX + 1) * static_cast<uint64_t>(maxY - minY + 1) * cellQueryCost > boxes.size())
+		{
+			for (uint32_t id = 0; id < boxes.size(); id++)			// ids are already in order
+				if (boxes[id].intersects(area)) ids.push_back(id);
+			return;
+		}
+
+		visitMark++;
+		if (visitMark == 0)											// marks went around, old ones can't be told apart from new ones
+		{
+			std::fill(visitMarks.begin(), visitMarks.end(), 0);
+			visitMark = 1;
+		}
+
+		for (int64_t x = minX; x <= maxX; x++)
+			for (int64_t y = minY; y <= maxY; y++)
+			{
+				auto cell = cells.find(cellKey(x, y));
+				if (cell == cells.end()) continue;
+
+				for (uint32_t id : cell->second)
+				{
+					if (visitMarks[id] == visitMark) continue;
+					visitMarks[id] = visitMark;
+					if (boxes[id].intersects(area)) ids.push_back(id);
+				}
+			}
+
+		for (uint32_t id : largeItems)
+			if (boxes[id].intersects(area)) ids.push_back(id);
+
+		std::sort(ids.begin() + firstFound, ids.end());
+	}
+
+
+
+
+	// Document
+
+	Document::Document(double cellSize)
+		:	grid(cellSize)
+	{	}
+
+
+	uint32_t Document::add(unique_ptr<PolyLine> polyLine)
+	{
+		auto box = polyLine->getBoundingBox();
+		boundingBox.add(box);
+		polyLine->setTessellationPool(&tessellationPool);
+		polyLines.push_back(std::move(polyLine));
+		revision++;
+		return grid.insert(box);
+	}
+
+
+	BoundingBox<double> Document::getBoundingBox() { return boundingBox; }
+	WorkStealingPool& Document::getTessellationPool() { return tessellationPool; }
+
+
+	void Document::findPolyLines(BoundingBox<double> area, vector<uint32_t>& ids)
+	{
+		grid.query(area, ids);
+	}
+
+
+	unsigned long Document::getRevision() { return revision; }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Primitives.h"
+#include "Polyline.h"
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+
+
+namespace obj
+{
+	// SpatialGrid is a uniform grid over the whole plane. Every cell keeps ids of boxes that overlap it, only cells that aren't empty
+	// are kept (hash map), so the plane has no bounds. Boxes that would cover too many cells go to one list that every query checks,
+	// so one huge polyline doesn't fill thousands of cells. Query of big area goes through all boxes instead of cells, when it's faster.
+	// Cells come from the grid's own pool, not one by one from global heap
+	class SpatialGrid
+	{
+		double cellSize;
+		std::pmr::unsynchronized_pool_resource cellMemory;			// declared before cells, so it outlives them
+		std::pmr::unordered_map<uint64_t, std::pmr::vector<uint32_t>> cells;
+		vector<uint32_t> largeItems;								// ids of boxes that cover more than maxCellsPerItem cells
+		vector<BoundingBox<double>> boxes;							// box of every item, id is the index
+		vector<uint32_t> visitMarks;								// items found by query are marked, so the ones in many cells are reported once
+		uint32_t visitMark = 0;
+
+		inline int64_t cellCoordinate(double value);
+		inline uint64_t cellKey(int64_t x, int64_t y);
+	public:
+		static const uint64_t maxCellsPerItem = 64;
+		static const uint64_t cellQueryCost = 8;					// looking into one cell takes about as long as checking 8 boxes (hash lookup)
+
+		SpatialGrid(double cellSize);
+		SpatialGrid(const SpatialGrid&) = delete;
+		uint32_t insert(BoundingBox<double> box);					// returns id of the box, ids are given in order from 0
+		void query(BoundingBox<double> area, vector<uint32_t>& ids);	// adds ids of boxes that intersect area, in ascending order
+		inline size_t size() { return boxes.size(); }
+		inline BoundingBox<double>& getBoxAt(uint32_t id) { return boxes[id]; }
+	};
+
+
+
+
+	// Document keeps finished polylines with their bounding boxes in a spatial grid, so drawing and hit-testing
+	// go only through polylines near the area, not through the whole drawing. Id of polyline is the order it was added in
+	class Document
+	{
+		WorkStealingPool tessellationPool;							// shared by all polylines, declared first so it outlives them
+		vector<unique_ptr<PolyLine>> polyLines;
+		SpatialGrid grid;
+		BoundingBox<double> boundingBox;							// box around all polylines
+		unsigned long revision = 0;									// rises after every change, so drawn vertexes are made again only when they're outdated
+
+	public:
+		static constexpr double defaultCellSize = 0.1;				// model units, the window is 2 units high
+
+		Document(double cellSize = defaultCellSize);
+		Document(const Document&) = delete;
+
+		uint32_t add(unique_ptr<PolyLine> polyLine);				// takes polyline and returns its id
+		inline size_t size() { return polyLines.size(); }
+		inline PolyLine& getPolyLine(uint32_t id) { return *polyLines[id]; }
+		inline BoundingBox<double>& getBoundingBox(uint32_t id) { return grid.getBoxAt(id); }
+		BoundingBox<double> getBoundingBox();
+		void findPolyLines(BoundingBox<double> area, vector<uint32_t>& ids);	// adds ids of polylines whose boxes intersect area, in ascending order
+		unsigned long getRevision();
+		WorkStealingPool& getTessellationPool();
+	};
+}
@@ -0,0 +1,372 @@
+#include "DxfFile.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if __has_include(<charconv>)
+	#include <charconv>
+#endif
+
+
+
+namespace obj
+{
+	// numbers are read and written with from_chars / to_chars when the standard library has them for double (shortest exact text, no locale),
+	// otherwise with strtod / snprintf
+
+	static bool parseDouble(const char* text, double& value)
+	{
+		if (*text == '+') text++;
+#ifdef __cpp_lib_to_chars
+		const char* end = text + std::strlen(text);
+		auto result = std::from_chars(text, end, value);
+		return (result.ec == std::errc()) && (result.ptr == end) && (text != end);
+#else
+		char* end;
+		value = std::strtod(text, &end);
+		return (end != text) && (*end == '\0');
+#endif
+	}
+
+
+	static bool parseInteger(const char* text, int& value)
+	{
+		bool negative = (*text == '-');
+		if ((*text == '-') || (*text == '+')) text++;
+		if (*text == '\0') return false;
+
+		long long number = 0;
+		for (; *text != '\0'; text++)
+		{
+			if ((*text < '0') || (*text > '9') || (number > 100000000)) return false;
+			number = 10 * number + (*text - '0');
+		}
+		value = static_cast<int>(negative ? -number : number);
+		return true;
+	}
+
+
+	static size_t formatDouble(char* text, size_t size, double value)
+	{
+#ifdef __cpp_lib_to_chars
+		return std::to_chars(text, text + size, value).ptr - text;
+#else
+		return std::snprintf(text, size, "%.17g", value);
+#endif
+	}
+
+
+	// node that goes from begin to end point. Bulge is tan(sweep / 4), arcs with bulge near zero are lines
+	static Node createSegment(Point<double> beginPoint, Point<double> endPoint, double bulge)
+	{
+		auto chord = Vector<double>(beginPoint, endPoint);
+		if ((std::fabs(bulge) < 1e-12) || (chord.getLength() == 0))
+			return Node(NodeKind::Line, endPoint);
+
+		double centerDistance = (1 - bulge * bulge) / (4 * bulge);			// distance from chord middle to center, in chord lengths (left side is positive)
+		auto center = Point<double>((beginPoint.x + endPoint.x) / 2 - centerDistance * chord.y, (beginPoint.y + endPoint.y) / 2 + centerDistance * chord.x);
+		auto arc = Arc(beginPoint, endPoint, center, bulge > 0);
+		return Node(endPoint, arc);
+	}
+
+
+
+
+	// DxfReader
+
+	DxfReader::DxfReader(const string& path)
+		:	file(std::fopen(path.c_str(), "rb")),
+			buffer(bufferSize + 1)										// one more character for null after the last line
+	{	}
+
+
+	DxfReader::~DxfReader()
+	{
+		if (file != nullptr) std::fclose(file);
+	}
+
+
+	bool DxfReader::isOpen() { return (file != nullptr); }
+	bool DxfReader::hasFailed() { return failed; }
+	uint64_t DxfReader::getBytesRead() { return bytesRead; }
+
+
+	char* DxfReader::readLine()
+	{
+		if (file == nullptr) return nullptr;
+
+		while (true)
+		{
+			char* begin = buffer.data() + lineBegin;
+			char* end = static_cast<char*>(std::memchr(begin, '\n', dataEnd - lineBegin));
+
+			if ((end == nullptr) && endOfFile)							// the last line may have no end of line
+			{
+				if (lineBegin == dataEnd) return nullptr;
+				end = buffer.data() + dataEnd;
+			}
+
+			if (end != nullptr)
+			{
+				lineBegin = (end - buffer.data()) + ((end == buffer.data() + dataEnd) ? 0 : 1);
+				while ((end > begin) && ((end[-1] == '\r') || (end[-1] == ' ') || (end[-1] == '\t')))
+					end--;
+				*end = '\0';
+				while ((*begin == ' ') || (*begin == '\t'))
+					begin++;
+				return begin;
+			}
+
+			if (lineBegin > 0)											// unread part is moved to the beginning, the rest of buffer is filled from file
+			{
+				std::memmove(buffer.data(), begin, dataEnd - lineBegin);
+				dataEnd -= lineBegin;
+				lineBegin = 0;
+			}
+			if (dataEnd == bufferSize)									// line doesn't fit in buffer
+			{
+				failed = true;
+				return nullptr;
+			}
+
+			size_t count = std::fread(buffer.data() + dataEnd, 1, bufferSize - dataEnd, file);
+			dataEnd += count;
+			bytesRead += count;
+			if (count == 0)
+			{
+				endOfFile = true;
+				if (std::ferror(file)) failed = true;
+			}
+		}
+	}
+
+
+	bool DxfReader::readGroup()
+	{
+		char* codeLine = readLine();
+		if (codeLine == nullptr) return false;
+		if (!parseInteger(codeLine, groupCode))
+		{
+			failed = true;
+			return false;
+		}
+
+		groupValue = readLine();
+		if (groupValue == nullptr)										// code without value
+		{
+			failed = true;
+			return false;
+		}
+		return true;
+	}
+
+
+	unique_ptr<PolyLine> DxfReader::readPolyLine()
+	{
+		while (groupPending || readGroup())
+		{
+			groupPending = false;
+			if ((groupCode == 0) && (std::strcmp(groupValue, "LWPOLYLINE") == 0))
+			{
+				auto polyLine = readLwPolyline();
+				if (polyLine || failed) return polyLine;				// polylines without vertexes are skipped
+			}
+		}
+		return nullptr;
+	}
+
+
+	unique_ptr<PolyLine> DxfReader::readLwPolyline()
+	{
+		unique_ptr<PolyLine> polyLine;
+		Point<double> firstPoint, previousPoint;
+		double previousBulge = 0;
+
+		Point<double> vertex = Point<double>(0, 0);
+		double bulge = 0;
+		bool vertexExists = false;
+		bool closed = false;
+
+		auto addVertex = [&]()											// vertex is added when the next one begins, because its bulge comes after its coordinates
+		{
+			if (!polyLine)
+			{
+				polyLine = make_unique<PolyLine>(vertex);
+				firstPoint = vertex;
+			}
+			else
+			{
+				auto node = createSegment(previousPoint, vertex, previousBulge);
+				polyLine->addNode(node);
+			}
+			previousPoint = vertex;
+			previousBulge = bulge;
+		};
+
+		while (readGroup())
+		{
+			if (groupCode == 0)											// the next entity begins
+			{
+				groupPending = true;
+				break;
+			}
+
+			double value = 0;
+			int flags = 0;
+			switch (groupCode)
+			{
+			case 10:
+				if (vertexExists) addVertex();
+				if (!parseDouble(groupValue, value)) failed = true;
+				vertex = Point<double>(value, 0);
+				bulge = 0;
+				vertexExists = true;
+				break;
+			case 20:
+				if (!parseDouble(groupValue, value)) failed = true;
+				vertex.y = value;
+				break;
+			case 42:
+				if (!parseDouble(groupValue, value)) failed = true;
+				bulge = value;
+				break;
+			case 70:
+				if (!parseInteger(groupValue, flags)) failed = true;
+				else closed = ((flags & 1) != 0);
+				break;
+			}
+			if (failed) return nullptr;
+		}
+		if (failed) return nullptr;
+
+		if (vertexExists) addVertex();
+		if (closed && polyLine && ((previousPoint.x != firstPoint.x) || (previousPoint.y != firstPoint.y)))
+		{
+			auto node = createSegment(previousPoint, firstPoint, previousBulge);
+			polyLine->addNode(node);
+		}
+		return polyLine;
+	}
+
+
+
+
+	// DxfWriter
+
+	DxfWriter::DxfWriter(const string& path)
+		:	file(std::fopen(path.c_str(), "wb"))
+	{
+		if (file == nullptr) return;
+		std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+		writeGroup(0, "SECTION");
+		writeGroup(2, "HEADER");
+		writeGroup(9, "$ACADVER");
+		writeGroup(1, "AC1015");										// AutoCAD 2000, the first version with LWPOLYLINE in this form
+		writeGroup(0, "ENDSEC");
+		writeGroup(0, "SECTION");
+		writeGroup(2, "ENTITIES");
+	}
+
+
+	DxfWriter::~DxfWriter()
+	{
+		close();
+	}
+
+
+	bool DxfWriter::isOpen() { return (file != nullptr); }
+
+
+	void DxfWriter::writeGroup(int code, const char* value)
+	{
+		writeGroup(code, value, std::strlen(value));
+	}
+
+
+	void DxfWriter::writeGroup(int code, const char* value, size_t valueLength)
+	{
+		char text[64];													// code right aligned to 3 characters and value go to file in one write, it's called several times for every vertex
+		size_t length = 0;
+		char digits[12];
+		size_t digitsCount = 0;
+		unsigned int number = static_cast<unsigned int>(code);
+		do
+		{
+			digits[digitsCount++] = static_cast<char>('0' + number % 10);
+			number /= 10;
+		} while (number != 0);
+		while (length + digitsCount < 3) text[length++] = ' ';
+		while (digitsCount > 0) text[length++] = digits[--digitsCount];
+		text[length++] = '\n';
+
+		if (length + valueLength + 1 > sizeof(text))					// long text values are written apart
+		{
+			if (std::fwrite(text, 1, length, file) != length) failed = true;
+			if (std::fwrite(value, 1, valueLength, file) != valueLength) failed = true;
+			if (std::fputc('\n', file) == EOF) failed = true;
+			return;
+		}
+		std::memcpy(text + length, value, valueLength);
+		length += valueLength;
+		text[length++] = '\n';
+		if (std::fwrite(text, 1, length, file) != length) failed = true;
+	}
+
+
+	void DxfWriter::writeGroup(int code, double value)
+	{
+		char valueText[32];
+		writeGroup(code, valueText, formatDouble(valueText, sizeof(valueText), value));
+	}
+
+
+	void DxfWriter::writeGroup(int code, unsigned int value)
+	{
+		char valueText[16];
+		size_t length = std::snprintf(valueText, sizeof(valueText), "%u", value);
+		writeGroup(code, valueText, length);
+	}
+
+
+	void DxfWriter::write(PolyLine& polyLine)
+	{
+		if (file == nullptr) return;
+
+		NodeStore& nodes = polyLine.getNodes();
+		size_t nodesCount = nodes.size();
+
+		char handleText[16];
+		std::snprintf(handleText, sizeof(handleText), "%X", handle++);
+
+		writeGroup(0, "LWPOLYLINE");
+		writeGroup(5, handleText);
+		writeGroup(100, "AcDbEntity");
+		writeGroup(8, "0");
+		writeGroup(100, "AcDbPolyline");
+		writeGroup(90, static_cast<unsigned int>(nodesCount));
+		writeGroup(70, 0u);
+
+		for (size_t i = 0; i < nodesCount; i++)							// bulge of vertex describes the segment after it, so it's taken from the next node
+		{
+			auto point = nodes.getEndPointAt(i);
+			writeGroup(10, point.x);
+			writeGroup(20, point.y);
+
+			if ((i + 1 < nodesCount) && (nodes.getKindAt(i + 1) == NodeKind::Arc))
+				writeGroup(42, std::tan(nodes.getArcAt(i + 1).getSweep() / 4));
+		}
+	}
+
+
+	bool DxfWriter::close()
+	{
+		if (file == nullptr) return false;
+
+		writeGroup(0, "ENDSEC");
+		writeGroup(0, "EOF");
+		if (std::fclose(file) != 0) failed = true;
+		file = nullptr;
+		return !failed;
+	}
+}
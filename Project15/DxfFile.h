@@ -0,0 +1,71 @@
+#pragma once
+#include "Polyline.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+
+
+namespace obj
+{
+	using std::string;
+
+
+	// DxfReader reads LWPOLYLINE entities from DXF file, one polyline at a time, other entities are skipped.
+	// File is read through a buffer of fixed size, so memory doesn't depend on file size, only on the size of the polyline being read.
+	// Every vertex of LWPOLYLINE can have bulge (group 42) of the segment that begins in it: tan(sweep / 4), positive for counterclockwise arcs.
+	// Segments with bulge become arc nodes, others become line nodes. Arcs are kept as they are in file, even if they aren't tangent
+	class DxfReader
+	{
+		FILE* file;
+		vector<char> buffer;
+		size_t lineBegin = 0;								// unread part of buffer
+		size_t dataEnd = 0;
+		bool endOfFile = false;
+		bool failed = false;
+		uint64_t bytesRead = 0;
+
+		int groupCode = 0;									// the last read group
+		char* groupValue = nullptr;							// null terminated, valid until the next group is read
+		bool groupPending = false;							// the last group hasn't been used yet (it begins the next entity)
+
+		char* readLine();									// returns null terminated line without end of line characters, nullptr at the end of file
+		bool readGroup();									// reads code and value, returns false at the end of file
+		unique_ptr<PolyLine> readLwPolyline();
+	public:
+		static const size_t bufferSize = 1 << 20;			// the longest line has to fit in it
+
+		DxfReader(const string& path);
+		~DxfReader();
+		DxfReader(const DxfReader&) = delete;
+
+		bool isOpen();
+		bool hasFailed();									// true when file was damaged (ex. line longer than buffer or a number that can't be read)
+		uint64_t getBytesRead();
+		unique_ptr<PolyLine> readPolyLine();				// returns the next polyline, nullptr at the end of file or when reading failed
+	};
+
+
+
+
+	// DxfWriter writes polylines as LWPOLYLINE entities of DXF file (AutoCAD 2000 format). Arc nodes are written as bulges of their begin vertexes
+	class DxfWriter
+	{
+		FILE* file;
+		bool failed = false;
+		unsigned int handle = 0x100;						// every entity gets its own handle
+
+		void writeGroup(int code, const char* value);
+		void writeGroup(int code, const char* value, size_t valueLength);
+		void writeGroup(int code, double value);
+		void writeGroup(int code, unsigned int value);
+	public:
+		DxfWriter(const string& path);						// writes the beginning of file
+		~DxfWriter();
+		DxfWriter(const DxfWriter&) = delete;
+
+		bool isOpen();
+		void write(PolyLine& polyLine);
+		bool close();										// writes the end of file and closes it, returns false when anything couldn't be written
+	};
+}
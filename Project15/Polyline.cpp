@@ -1,122 +1,563 @@
 #include "Polyline.h"
+#include <algorithm>
+#include <functional>
 
 
 namespace obj
 {
 	// Node
 
-	Node::Node(Point<double>& beginPoint)
-		:	endPoint(beginPoint)
+	Node::Node(NodeKind kind, Point<double> endPoint)
+		:	kind(kind),
+			endPoint(endPoint)
 	{	}
-	
-	Point<double> Node::getEndPoint() { return this->endPoint; }
-	
 
+	Node::Node(Point<double> endPoint, Arc& arc)
+		:	kind(NodeKind::Arc),
+			endPoint(endPoint),
+			arc(arc)
+	{	}
 
 
-	//FirstNode
-	
-	bool FirstNode::isArc() { return false; }
-	bool FirstNode::isFirstNode() { return true; }
-	bool ArcNode::isFirstNode() { return false; }
-	FirstNode::FirstNode(Point<double>& point)
-		: Node(point)
-	{	}
+	unsigned int Node::vertexCount(ArcAccuracy accuracy)
+	{
+		if (isArc()) return arc.vertexCount(accuracy);
+		return 1;
+	}
 
-	void FirstNode::generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy)
+	void Node::generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy)
 	{
-		vertexChain.add(endPoint);
+		if (isArc())
+			arc.generateVertexes(vertexBuffer, accuracy);
+		else
+			vertexBuffer.add(endPoint);
 	}
-	
 
+	void Node::generatePeakPoints(vector<Point<double>>& points)
+	{
+		if (isArc())
+			points.push_back(arc.getPeakPoint());
+	}
 
 
-	// LineNode
-	
-	bool LineNode::isArc() { return false; }
 
-	LineNode::LineNode(Point<double> newPoint)
-		:	Node(newPoint)
-	{	}
 
-	bool LineNode::isFirstNode() { return false; }
 
-	void LineNode::generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy)
+	// NodeStore
+
+	void NodeStore::push(Node& node)
 	{
-		vertexChain.add(endPoint);
+		forgetRemovedNodes();
+
+		kinds.push_back(node.kind);
+		endPoints.push_back(node.endPoint);
+		arcIndexes.push_back(static_cast<unsigned int>(arcs.size()));
+
+		if (node.isArc())
+		{
+			arcs.push_back(node.arc);
+			peakPoints.push_back(node.arc.getPeakPoint());		// arc never changes, so its peak point is computed only once
+		}
+		nodesCount++;
 	}
 
 
+	Node NodeStore::pop()
+	{
+		nodesCount--;
 
+		Node node = Node(kinds[nodesCount], endPoints[nodesCount]);
+		if (node.isArc())
+			node.arc = arcs[arcIndexes[nodesCount]];
+		return node;
+	}
 
 
-	// ArcNode
+	void NodeStore::restore()
+	{
+		nodesCount++;
+	}
 
-	bool ArcNode::isArc() { return true; }
 
+	void NodeStore::forgetRemovedNodes()
+	{
+		if (removedNodesCount() == 0) return;
 
-	Point<double> ArcNode::arcCenter() { return arc->getCenterPoint(); }
+		size_t arcsCount = arcsBefore(nodesCount);
+		arcs.resize(arcsCount);
+		peakPoints.resize(arcsCount);
+		kinds.resize(nodesCount);
+		endPoints.resize(nodesCount);
+		arcIndexes.resize(nodesCount);
 
+		if (vertexEnds.size() > nodesCount)					// vertexes of removed nodes are cut off the cache
+		{
+			vertexEnds.resize(nodesCount);
+			vertexes.truncate(vertexEnds.empty() ? 0 : vertexEnds.back());
+		}
+		size_t keptChunks = chunksCount();					// vertexes of removed nodes are cut off chunks too
+		for (size_t chunk = keptChunks; chunk < chunkVertexes.size(); chunk++)
+			chunkVertexesCount -= chunkVertexes[chunk].vertexes.size();
+		if (chunkVertexes.size() > keptChunks) chunkVertexes.resize(keptChunks);
+		if ((keptChunks > 0) && (chunkVertexes.size() == keptChunks))
+		{
+			auto& cache = chunkVertexes.back();
+			size_t keptNodes = nodesCount - (keptChunks - 1) * chunkSize;
+			if (cache.vertexEnds.size() > keptNodes)
+			{
+				cache.vertexEnds.resize(keptNodes);
+				chunkVertexesCount -= cache.vertexes.size() - cache.vertexEnds.back();
+				cache.vertexes.truncate(cache.vertexEnds.back());
+			}
+		}
+
+		if (boxedNodesCount > nodesCount)					// chunk with removed nodes is made again when it's needed
+		{
+			chunkBoxes.resize(nodesCount / chunkSize);
+			blockBoxes.resize(chunkBoxes.size() * (chunkSize / blockSize));
+			boxedNodesCount = chunkBoxes.size() * chunkSize;
+
+			groupBoxes.resize((chunkBoxes.size() + chunkGroupSize - 1) / chunkGroupSize);
+			if (chunkBoxes.size() % chunkGroupSize != 0)	// group box is made again from chunks that are left
+			{
+				groupBoxes.back() = BoundingBox<double>();
+				for (size_t chunk = chunkBoxes.size() / chunkGroupSize * chunkGroupSize; chunk < chunkBoxes.size(); chunk++)
+					groupBoxes.back().add(chunkBoxes[chunk]);
+			}
+		}
+	}
 
-	void ArcNode::generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy)
+
+	void NodeStore::addToChunkBox(size_t index)
 	{
-		arc->generateVertexes(vertexChain, accuracy);
+		if (index % blockSize == 0)							// new block begins with the end point of the node before, its section or arc leads to this node
+		{
+			if (index % chunkSize == 0)
+			{
+				if (chunkBoxes.size() % chunkGroupSize == 0) groupBoxes.push_back(BoundingBox<double>());
+				chunkBoxes.push_back(BoundingBox<double>());
+			}
+			blockBoxes.push_back(BoundingBox<double>());
+			if (index > 0) blockBoxes.back().add(endPoints[index - 1]);
+		}
+
+		BoundingBox<double>& box = blockBoxes.back();
+		box.add(endPoints[index]);
+		if (kinds[index] == NodeKind::Arc) arcs[arcIndexes[index]].addExtremes(box);
+		chunkBoxes.back().add(box);
+		groupBoxes.back().add(box);
 	}
 
-	void ArcNode::generatePeakPoints(vector<Point<double>>& points)
+
+	void NodeStore::updateChunkBoxes()
 	{
-		auto peakPoint = arc->getPeakPoint();
-		points.push_back(peakPoint);
+		for (size_t i = boxedNodesCount; i < kinds.size(); i++)
+			addToChunkBox(i);
+		boxedNodesCount = kinds.size();
 	}
 
 
-	Point<double> ArcNode::getPeakPoint() { return arc->getPeakPoint(); }
+	void NodeStore::tessellate(ArcAccuracy accuracy)
+	{
+		if (accuracy != tessellationAccuracy)
+		{
+			vertexes.clear();
+			vertexEnds.clear();
+			tessellationAccuracy = accuracy;
+		}
+
+		if (vertexEnds.size() >= nodesCount) return;
+		if ((tessellationPool != nullptr) && (tessellationPool->size() > 1) && (nodesCount - vertexEnds.size() >= minParallelNodes))
+		{
+			tessellateParallel(accuracy);
+			return;
+		}
+		vertexes.reserve(vertexCount(accuracy));
+		vertexEnds.reserve(nodesCount);
 
-	ArcNode::ArcNode(Node& previousNode, PolyLine* polyLine, Point<double> newPoint)
-		:	Node(newPoint)
+		for (size_t i = vertexEnds.size(); i < nodesCount; i++)
+		{
+			if (kinds[i] == NodeKind::Arc)
+				arcs[arcIndexes[i]].generateVertexes(vertexes, accuracy);
+			else
+				vertexes.add(endPoints[i]);
+
+			vertexEnds.push_back(vertexes.size());
+		}
+	}
+
+
+	void NodeStore::tessellateParallel(ArcAccuracy accuracy)
 	{
-		if (previousNode.isFirstNode()) throw std::exception();
+		size_t firstNode = vertexEnds.size();
+		vertexEnds.resize(nodesCount);
 
-		auto lastNodeIndex = polyLine->lastNodeIndex();
-		auto previousNodeEndPt = polyLine->getNodeAt(lastNodeIndex).getEndPoint();
-		auto previousNodeBeginPt = polyLine->getNodeAt(lastNodeIndex - 1).getEndPoint();
+		tessellationPool->parallelFor(firstNode, nodesCount, tessellationGrain, [&](size_t first, size_t end)
+		{
+			for (size_t i = first; i < end; i++)
+				vertexEnds[i] = (kinds[i] == NodeKind::Arc) ? arcs[arcIndexes[i]].vertexCount(accuracy) : 1;
+		});
 
-		if (previousNode.isArc())
+		size_t vertexEnd = vertexes.size();							// counts become ends, like in serial tessellation
+		for (size_t i = firstNode; i < nodesCount; i++)
 		{
-			ArcNode& previousArc = dynamic_cast<ArcNode&>(previousNode);
-			
-			auto arcCenter = previousArc.arcCenter();
-			auto newArc = createArcAfterArc(arcCenter, previousNodeEndPt, newPoint, previousNode);
+			vertexEnd += vertexEnds[i];
+			vertexEnds[i] = vertexEnd;
+		}
+		vertexes.reserve(vertexEnd);
+		vertexes.grow(vertexEnd - vertexes.size());
+
+		double* xs = vertexes.getX();
+		double* ys = vertexes.getY();
+		tessellationPool->parallelFor(firstNode, nodesCount, tessellationGrain, [&](size_t first, size_t end)
+		{
+			for (size_t i = first; i < end; i++)
+			{
+				size_t firstVertex = (i > 0) ? vertexEnds[i - 1] : 0;
+				if (kinds[i] == NodeKind::Arc)
+					arcs[arcIndexes[i]].generateVertexes(xs + firstVertex, ys + firstVertex, accuracy);
+				else
+				{
+					xs[firstVertex] = endPoints[i].x;
+					ys[firstVertex] = endPoints[i].y;
+				}
+			}
+		});
+	}
+
 
-			arc.swap(newArc);
+	size_t NodeStore::vertexCount(ArcAccuracy accuracy)
+	{
+		size_t count = 0;
+		size_t i = 0;
+		if (accuracy == tessellationAccuracy)
+		{
+			i = (vertexEnds.size() < nodesCount) ? vertexEnds.size() : nodesCount;
+			count = (i > 0) ? vertexEnds[i - 1] : 0;
 		}
+
+		for (; i < nodesCount; i++)
+		{
+			if (kinds[i] == NodeKind::Arc)
+				count += arcs[arcIndexes[i]].vertexCount(accuracy);
+			else
+				count++;
+		}
+		return count;
+	}
+
+
+	void NodeStore::generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy)
+	{
+		tessellate(accuracy);
+		vertexBuffer.add(vertexes, (nodesCount > 0) ? vertexEnds[nodesCount - 1] : 0);	// cache can hold vertexes of removed nodes too
+	}
+
+
+	void NodeStore::generatePeakPoints(vector<Point<double>>& points)
+	{
+		points.insert(points.end(), peakPoints.begin(), peakPoints.begin() + arcsBefore(nodesCount));
+	}
+
+
+	BoundingBox<double> NodeStore::getBoundingBox()
+	{
+		updateChunkBoxes();
+		auto box = BoundingBox<double>();
+		for (size_t chunk = 0; chunk < chunksCount(); chunk++)
+			box.add(chunkBoxes[chunk]);
+		return box;
+	}
+
+
+	void NodeStore::tessellateChunk(size_t chunk, ArcAccuracy accuracy)
+	{
+		auto& cache = chunkVertexes[chunk];
+		if (cache.accuracy != accuracy)
+		{
+			cache.vertexes.clear();
+			cache.vertexEnds.clear();
+			cache.accuracy = accuracy;
+		}
+
+		size_t firstNode = chunk * chunkSize;
+		size_t endNode = (firstNode + chunkSize < nodesCount) ? firstNode + chunkSize : nodesCount;
+		for (size_t i = firstNode + cache.vertexEnds.size(); i < endNode; i++)
+		{
+			if (kinds[i] == NodeKind::Arc)
+				arcs[arcIndexes[i]].generateVertexes(cache.vertexes, accuracy);
+			else
+				cache.vertexes.add(endPoints[i]);
+
+			cache.vertexEnds.push_back(static_cast<unsigned int>(cache.vertexes.size()));
+		}
+	}
+
+
+	void NodeStore::tessellateVisibleChunks(ArcAccuracy accuracy)
+	{
+		for (auto chunk : staleChunks)
+			chunkVertexesCount -= chunkVertexes[chunk].vertexes.size();
+
+		if ((tessellationPool != nullptr) && (tessellationPool->size() > 1) && (staleChunks.size() * chunkSize >= minParallelNodes))
+			tessellationPool->parallelFor(0, staleChunks.size(), 1, [&](size_t first, size_t end)
+			{
+				for (size_t i = first; i < end; i++)
+					tessellateChunk(staleChunks[i], accuracy);
+			});
 		else
+			for (auto chunk : staleChunks)
+				tessellateChunk(chunk, accuracy);
+
+		for (auto chunk : staleChunks)
+			chunkVertexesCount += chunkVertexes[chunk].vertexes.size();
+
+		if (chunkVertexesCount <= maxChunkVertexes) return;
+		for (auto& cache : chunkVertexes)							// chunks out of view are made again when they come back
+			if (cache.lastFrame != visibleFrame)
+			{
+				chunkVertexesCount -= cache.vertexes.size();
+				cache = ChunkVertexes();
+			}
+	}
+
+
+	bool NodeStore::generateVisibleVertexChain(VertexBuffer<double>& vertexBuffer, vector<size_t>& stripEnds, ArcAccuracy accuracy, BoundingBox<double>& area)
+	{
+		updateChunkBoxes();
+		size_t count = chunksCount();
+		if (chunkVertexes.size() < count) chunkVertexes.resize(count);
+		visibleFrame++;
+
+		staleChunks.clear();
+		for (size_t chunk = 0; chunk < count; chunk++)
 		{
-			auto newArc = createArcAfterSection(previousNodeBeginPt, previousNodeEndPt, newPoint);
+			if (!chunkBoxes[chunk].intersects(area)) continue;
 
-			arc.swap(newArc);
+			auto& cache = chunkVertexes[chunk];
+			cache.lastFrame = visibleFrame;
+			size_t chunkNodes = ((chunk + 1) * chunkSize < nodesCount) ? chunkSize : nodesCount - chunk * chunkSize;
+			if ((cache.accuracy != accuracy) || (cache.vertexEnds.size() < chunkNodes)) staleChunks.push_back(chunk);
 		}
+		tessellateVisibleChunks(accuracy);
+
+		bool lastNodeVisible = false;
+		size_t chunk = 0;
+		while (chunk < count)
+		{
+			if (!chunkBoxes[chunk].intersects(area))
+			{
+				chunk++;
+				continue;
+			}
+
+			if (chunk > 0) vertexBuffer.add(endPoints[chunk * chunkSize - 1]);	// strip begins in the end point of the node before chunk
+			while ((chunk < count) && chunkBoxes[chunk].intersects(area))
+			{
+				auto& cache = chunkVertexes[chunk];
+				size_t chunkNodes = ((chunk + 1) * chunkSize < nodesCount) ? chunkSize : nodesCount - chunk * chunkSize;
+				vertexBuffer.add(cache.vertexes, cache.vertexEnds[chunkNodes - 1]);	// cache can hold vertexes of removed nodes too
+				chunk++;
+			}
+			stripEnds.push_back(vertexBuffer.size());
+			lastNodeVisible = (chunk == count);
+		}
+		return lastNodeVisible;
 	}
 
 
-	unique_ptr<Arc> ArcNode::createArcAfterSection(Point<double>& previousNodeBeginPt, Point<double>& previousNodeEndPt, Point<double>& newPoint)
+	void NodeStore::generateVisiblePeakPoints(vector<Point<double>>& points, BoundingBox<double>& area)
 	{
-		auto previousSection = Section<double>(previousNodeBeginPt, previousNodeEndPt);
-		auto previousLine = LineInterface::createLine(previousSection);
+		updateChunkBoxes();
+		for (size_t chunk = 0; chunk < chunksCount(); chunk++)
+		{
+			if (!chunkBoxes[chunk].intersects(area)) continue;
+
+			size_t endNode = ((chunk + 1) * chunkSize < nodesCount) ? (chunk + 1) * chunkSize : nodesCount;
+			for (size_t i = arcsBefore(chunk * chunkSize); i < arcsBefore(endNode); i++)
+				if (area.contains(peakPoints[i])) points.push_back(peakPoints[i]);
+		}
+	}
 
-		auto radiusLine = previousLine->setPerpendicular(previousNodeEndPt);
 
-		unique_ptr<LineInterface> circleAxisLine;
-		setAxisLine(previousNodeEndPt, newPoint, circleAxisLine); 
 
-		Point<double> arcCenter;
-		if (radiusLine->getIntersectionPoint(*circleAxisLine, arcCenter))			
-			if(arcWillBeClockWiseAfterSection(previousNodeBeginPt, previousNodeEndPt, arcCenter))
-				return make_unique<ClockWiseArc>(previousNodeEndPt, newPoint, arcCenter);
-			else 
-				return make_unique<CounterClockWiseArc>(previousNodeEndPt, newPoint, arcCenter);
+
+
+	void NodeStore::findClosestPointInNode(size_t index, Point<double>& point, ClosestPoint& closest)
+	{
+		Point<double> nodePoint;
+		if (kinds[index] == NodeKind::First)
+			nodePoint = endPoints[index];
+		else if (kinds[index] == NodeKind::Arc)
+		{
+			Arc& arc = arcs[arcIndexes[index]];
+			auto center = arc.getCenterPoint();
+			double centerDistance = std::sqrt((center.x - point.x) * (center.x - point.x) + (center.y - point.y) * (center.y - point.y));
+			double circleDistance = centerDistance - arc.getRadius();
+			if (circleDistance * circleDistance >= closest.distance) return;		// whole circle is further than the nearest point found so far
+
+			if (!arc.projectPoint(point, nodePoint))							// the nearest point of circle isn't on arc, so one of its ends is the nearest
+			{
+				auto& beginPoint = endPoints[index - 1];
+				auto& endPoint = endPoints[index];
+				double beginDistance = (beginPoint.x - point.x) * (beginPoint.x - point.x) + (beginPoint.y - point.y) * (beginPoint.y - point.y);
+				double endDistance = (endPoint.x - point.x) * (endPoint.x - point.x) + (endPoint.y - point.y) * (endPoint.y - point.y);
+				nodePoint = (beginDistance < endDistance) ? beginPoint : endPoint;
+			}
+		}
+		else
+		{
+			auto sectionBox = BoundingBox<double>();
+			sectionBox.add(endPoints[index - 1]);
+			sectionBox.add(endPoints[index]);
+			if (sectionBox.distanceSquared(point) >= closest.distance) return;	// most sections are skipped without projecting the point
+
+			nodePoint = Section<double>(endPoints[index - 1], endPoints[index]).getClosestPoint(point);
+		}
+
+		double distanceX = nodePoint.x - point.x;
+		double distanceY = nodePoint.y - point.y;
+		double distance = distanceX * distanceX + distanceY * distanceY;
+		if (distance < closest.distance)
+		{
+			closest.point = nodePoint;
+			closest.distance = distance;
+			closest.nodeIndex = index;
+		}
+	}
+
+
+	void NodeStore::findClosestPoint(Point<double>& point, ClosestPoint& closest, vector<QueuedBox>& boxQueue)
+	{
+		closest = ClosestPoint();
+		size_t count = chunksCount();
+		auto further = std::greater<QueuedBox>();
+
+		boxQueue.clear();											// heap of boxes, the nearest one is on top
+		for (size_t group = 0; (group < groupBoxes.size()) && (group * chunkGroupSize < count); group++)
+			boxQueue.push_back(QueuedBox{ groupBoxes[group].distanceSquared(point), 2, group });
+		std::make_heap(boxQueue.begin(), boxQueue.end(), further);
+
+		while (!boxQueue.empty() && (boxQueue.front().distance < closest.distance))	// boxes further than the nearest point found so far can't have nearer one
+		{
+			auto box = boxQueue.front();
+			std::pop_heap(boxQueue.begin(), boxQueue.end(), further);
+			boxQueue.pop_back();
+
+			if (box.level == 0)
+			{
+				size_t endNode = std::min((box.index + 1) * blockSize, nodesCount);
+				for (size_t index = box.index * blockSize; index < endNode; index++)
+					findClosestPointInNode(index, point, closest);
+				continue;
+			}
+
+			auto& boxes = (box.level == 2) ? chunkBoxes : blockBoxes;		// boxes of the level below
+			size_t childrenCount = (box.level == 2) ? chunkGroupSize : chunkSize / blockSize;
+			size_t endChild = std::min((box.index + 1) * childrenCount, (box.level == 2) ? count : (nodesCount + blockSize - 1) / blockSize);
+			for (size_t child = box.index * childrenCount; child < endChild; child++)
+			{
+				double distance = boxes[child].distanceSquared(point);
+				if (distance >= closest.distance) continue;
+				boxQueue.push_back(QueuedBox{ distance, static_cast<unsigned char>(box.level - 1), child });
+				std::push_heap(boxQueue.begin(), boxQueue.end(), further);
+			}
+		}
+		closest.distance = std::sqrt(closest.distance);
+	}
+
+
+	ClosestPoint NodeStore::findClosestPoint(Point<double> point)
+	{
+		updateChunkBoxes();
+		ClosestPoint closest;
+		vector<QueuedBox> boxQueue;
+		findClosestPoint(point, closest, boxQueue);
+		return closest;
+	}
+
+
+	void NodeStore::findClosestPoints(const vector<Point<double>>& points, vector<ClosestPoint>& closestPoints)
+	{
+		updateChunkBoxes();											// ranges only read the store
+		closestPoints.resize(points.size());
+
+		auto findRange = [&](size_t first, size_t end)
+		{
+			vector<QueuedBox> boxQueue;
+			for (size_t i = first; i < end; i++)
+			{
+				auto point = points[i];
+				findClosestPoint(point, closestPoints[i], boxQueue);
+			}
+		};
+
+		if ((tessellationPool != nullptr) && (tessellationPool->size() > 1) && (points.size() > queryGrain))
+			tessellationPool->parallelFor(0, points.size(), queryGrain, findRange);
+		else
+			findRange(0, points.size());
+	}
+
+
+
+
+
+	// ArcNode
+
+	ArcNode::ArcNode(NodeStore& nodes, Point<double> newPoint)
+		:	endPoint(newPoint)
+	{
+		auto lastNodeIndex = nodes.size() - 1;
+		auto previousNodeKind = nodes.getKindAt(lastNodeIndex);
+		if (previousNodeKind == NodeKind::First)
+		{
+			error = ArcError::FirstNodeArc;
+			return;
+		}
+
+		auto previousNodeEndPt = nodes.getEndPointAt(lastNodeIndex);
+		auto previousNodeBeginPt = nodes.getEndPointAt(lastNodeIndex - 1);
+		if ((newPoint.x == previousNodeEndPt.x) && (newPoint.y == previousNodeEndPt.y))
+		{
+			error = ArcError::ZeroLengthSection;
+			return;
+		}
+
+		if (previousNodeKind == NodeKind::Arc)
+		{
+			auto arcCenter = nodes.getArcAt(lastNodeIndex).getCenterPoint();
+			auto previousNodePeak = nodes.getPeakPointAt(lastNodeIndex);
+			error = createArcAfterArc(arcCenter, previousNodeEndPt, newPoint, previousNodePeak);
+		}
 		else
-			throw std::exception();
+			error = createArcAfterSection(previousNodeBeginPt, previousNodeEndPt, newPoint);
+	}
+
+
+	Node ArcNode::getNode()
+	{
+		return Node(endPoint, arc);
+	}
+
+
+	ArcError ArcNode::createArcAfterSection(Point<double>& previousNodeBeginPt, Point<double>& previousNodeEndPt, Point<double>& newPoint)
+	{
+		if ((previousNodeBeginPt.x == previousNodeEndPt.x) && (previousNodeBeginPt.y == previousNodeEndPt.y)) return ArcError::ZeroLengthSection;
+
+		auto previousSection = Section<double>(previousNodeBeginPt, previousNodeEndPt);
+		auto previousLine = Line(previousSection);
+
+		auto radiusLine = previousLine.setPerpendicular(previousNodeEndPt);
+		auto circleAxisLine = setAxisLine(previousNodeEndPt, newPoint);
+
+		Point<double> arcCenter;
+		if (!radiusLine.getIntersectionPoint(circleAxisLine, arcCenter)) return ArcError::ParallelLines;
+
+		if (arcWillBeClockWiseAfterSection(previousNodeBeginPt, previousNodeEndPt, arcCenter))
+			arc = ClockWiseArc(previousNodeEndPt, newPoint, arcCenter);
+		else 
+			arc = CounterClockWiseArc(previousNodeEndPt, newPoint, arcCenter);
+		return ArcError::None;
 	}
 
 	bool ArcNode::arcWillBeClockWiseAfterSection(Point<double>& previousNodeBeginPt, Point<double>& arcFirstPoint, Point<double>& arcCenter)
@@ -130,24 +571,21 @@ namespace obj
 		return (hypotenuse.y > 0);
 	}
 
-	unique_ptr<Arc> ArcNode::createArcAfterArc(Point<double>& previousNodeCenter, Point<double>& previousNodeEndPt, Point<double>& newPoint, Node& previousNode)
+	ArcError ArcNode::createArcAfterArc(Point<double>& previousNodeCenter, Point<double>& previousNodeEndPt, Point<double>& newPoint, Point<double>& previousNodePeak)
 	{
-		unique_ptr<LineInterface> axisLine;
-		setAxisLine(previousNodeEndPt, newPoint, axisLine);
+		auto axisLine = setAxisLine(previousNodeEndPt, newPoint);
 			
 		auto radiusSection = Section<double>(previousNodeCenter, previousNodeEndPt);
-		auto radiusLine = LineInterface::createLine(radiusSection);
+		auto radiusLine = Line(radiusSection);
 		
-		ArcNode& previousNodeAsArc = dynamic_cast<ArcNode&>(previousNode);
-		Point<double> prewviousNodePeakPoint = previousNodeAsArc.getPeakPoint();
-
 		Point<double> arcCenter;
-		if (axisLine->getIntersectionPoint(*radiusLine, arcCenter))
-			if (arcWillBeClockWiseAfterArc(previousNodeCenter, prewviousNodePeakPoint, previousNodeEndPt, newPoint))
-				return make_unique<ClockWiseArc>(previousNodeEndPt, newPoint, arcCenter);		
-			else return make_unique<CounterClockWiseArc>(previousNodeEndPt, newPoint, arcCenter);
+		if (!axisLine.getIntersectionPoint(radiusLine, arcCenter)) return ArcError::ParallelLines;
+
+		if (arcWillBeClockWiseAfterArc(previousNodeCenter, previousNodePeak, previousNodeEndPt, newPoint))
+			arc = ClockWiseArc(previousNodeEndPt, newPoint, arcCenter);		
 		else
-			throw std::exception();
+			arc = CounterClockWiseArc(previousNodeEndPt, newPoint, arcCenter);
+		return ArcError::None;
 	}
 
 	bool ArcNode::arcWillBeClockWiseAfterArc(Point<double>& previousNodeCenter, Point<double>& previousNodePeak, Point<double>& arcFirstPoint, Point<double>& newPoint)
@@ -161,30 +599,143 @@ namespace obj
 		newPointVector.rotate(angleToRotateBack);
 		centerPeakVector.rotate(angleToRotateBack);
 
-		if (centerPeakVector.y > 0)
+		if (centerPeakVector.y > 0)							// previous arc comes to its end point counterclockwise
+			return (newPointVector.x < 0);
+		return (newPointVector.x > 0);						// clockwise, peak can't be on the radius line of the end point
+	}
+
+	Line ArcNode::setAxisLine(Point<double>& beginPoint, Point<double>& endPoint)
+	{
+		auto newSection = Section<double>(beginPoint, endPoint);
+		auto axisPoint = newSection.getMiddlePoint();
+
+		auto line = Line(newSection);
+		return line.setPerpendicular(axisPoint);
+	}
+
+
+
+
+
+	// PreviewTangent
+
+	void PreviewTangent::update(NodeStore& nodes)
+	{
+		size_t lastNodeIndex = nodes.size() - 1;
+		beginPoint = nodes.getEndPointAt(lastNodeIndex);
+		tangent = Vector<double>(0, 0);
+
+		auto lastNodeKind = nodes.getKindAt(lastNodeIndex);
+		if (lastNodeKind == NodeKind::Arc)
 		{
-			bool clockWise = (newPointVector.x < 0);
-			return clockWise;
+			auto& lastArc = nodes.getArcAt(lastNodeIndex);
+			auto center = lastArc.getCenterPoint();
+			auto radius = Vector<double>(center, beginPoint);
+			tangent = lastArc.isCounterClockWise() ? Vector<double>(-radius.y, radius.x) : Vector<double>(radius.y, -radius.x);
 		}
-		else
-		if(centerPeakVector.y < 0)
+		else if (lastNodeKind == NodeKind::Line)
 		{
-			bool clockWise = (newPointVector.x > 0);
-			return clockWise;
+			auto previousPoint = nodes.getEndPointAt(lastNodeIndex - 1);
+			tangent = Vector<double>(previousPoint, beginPoint);
 		}
 	}
 
-	void ArcNode::setAxisLine(Point<double>& beginPoint, Point<double>& endPoint, unique_ptr<LineInterface>& axisLine)
+
+
+
+
+	// PreviewNode
+
+	PreviewStatus PreviewNode::setLine(PreviewTangent& end, Point<double> point)
+	{
+		kind = NodeKind::Line;
+		beginPoint = end.beginPoint;
+		endPoint = point;
+		vertexesCount = 0;
+		shown = true;
+		return PreviewStatus::Shown;
+	}
+
+
+	PreviewStatus PreviewNode::setArc(PreviewTangent& end, Point<double> point)
 	{
-		auto newSection = Section<double>(beginPoint, endPoint);
-		auto axisPoint = newSection.getMiddlePoint();
+		shown = false;
+		beginPoint = end.beginPoint;
+		auto& tangent = end.tangent;
+		double tangentLength = tangent.getLength();
+		if (!(tangentLength > 0)) return PreviewStatus::NoTangent;
+
+		auto chord = Vector<double>(beginPoint, point);
+		double chordLength = chord.getLength();
+		double cross = (tangent.x * chord.y - tangent.y * chord.x) / tangentLength;	// distance of point from tangent line, positive on the left
+		if (!(std::fabs(cross) > 1e-12 * chordLength)) return PreviewStatus::OnTangentLine;
+
+		double radius = chordLength * chordLength / (2 * std::fabs(cross));
+		bool counterClockWise = (cross > 0);				// center is on the side the point is
+		double side = counterClockWise ? 1 : -1;
+		auto center = Point<double>(beginPoint.x - side * radius * tangent.y / tangentLength, beginPoint.y + side * radius * tangent.x / tangentLength);
+
+		kind = NodeKind::Arc;
+		endPoint = point;
+		arc = Arc(beginPoint, point, center, counterClockWise);
+		vertexesCount = 0;
+		shown = true;
+		return PreviewStatus::Shown;
+	}
 
-		auto line = LineInterface::createLine(newSection);
-		if (line)
+
+	void PreviewNode::generateVertexes(ArcAccuracy accuracy)
+	{
+		if ((vertexesCount > 0) && (vertexesAccuracy == accuracy)) return;
+		vertexesAccuracy = accuracy;
+
+		if (kind != NodeKind::Arc)
+		{
+			xs[0] = endPoint.x;
+			ys[0] = endPoint.y;
+			vertexesCount = 1;
+			return;
+		}
+
+		if (arc.vertexCount(accuracy) > capacity)			// fixed sections per circle, so that the whole sweep fits in buffer
 		{
-			auto newAxisLine = line->setPerpendicular(axisPoint);
-			axisLine.swap(newAxisLine);
+			double sections = (capacity - 1) * 2 * pi / std::fabs(arc.getSweep());
+			accuracy = ArcAccuracy(static_cast<unsigned int>(std::min(sections, static_cast<double>(ArcAccuracy::maxSections))));
 		}
+		vertexesCount = arc.vertexCount(accuracy);
+		arc.generateVertexes(xs.data(), ys.data(), accuracy);
+	}
+
+
+	BoundingBox<double> PreviewNode::getBoundingBox()
+	{
+		auto box = BoundingBox<double>();
+		box.add(beginPoint);
+		box.add(endPoint);
+		if (kind == NodeKind::Arc) arc.addExtremes(box);
+		return box;
+	}
+
+
+	size_t PreviewNode::vertexCount(ArcAccuracy accuracy)
+	{
+		generateVertexes(accuracy);
+		return vertexesCount;
+	}
+
+
+	void PreviewNode::generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy)
+	{
+		generateVertexes(accuracy);
+		for (size_t i = 0; i < vertexesCount; i++)
+			vertexBuffer.add(Point<double>(xs[i], ys[i]));
+	}
+
+
+	void PreviewNode::generatePeakPoints(vector<Point<double>>& points)
+	{
+		if (isArc())
+			points.push_back(getPeakPoint());
 	}
 
 
@@ -196,115 +747,144 @@ namespace obj
 	PolyLine::PolyLine(Point<double>& point)
 		: nodes()
 	{
-		unique_ptr<Node> firstNode = make_unique<FirstNode>(point);
-		nodes.push_back(move(firstNode));
+		auto firstNode = Node(NodeKind::First, point);
+		nodes.push(firstNode);
+		nodesChanged();
+	}
+
+
+	PolyLine::PolyLine(NodeStore&& nodes)
+		: nodes(std::move(nodes))
+	{
+		nodesChanged();
 	}
 
 
 	PolyLine::~PolyLine()
 	{	}
 
-	void PolyLine::blockDisplayNode() { displayNodeBlocked = true; }
-	void PolyLine::unBlockDisplayNode() { displayNodeBlocked = false; }
-
 
-	bool PolyLine::addDisplayLineNode(Point<double>& point)
+	void PolyLine::nodesChanged()
 	{
-		if (!displayNodeBlocked)
-		{
-			unique_ptr<Node> newDisplayNode = make_unique<LineNode>(point);
-			displayNode.swap(newDisplayNode);
-			return true;
-		}
-		return false;
+		previewTangent.update(nodes);
 	}
 
 
 	bool PolyLine::addLine(Point<double>& point)
 	{
-		try
-		{
-			displayNode.reset();
-			unique_ptr<Node> newNode = make_unique<LineNode>(point);	
-			nodes.push_back(move(newNode));
+		auto newNode = Node(NodeKind::Line, point);
+		nodes.push(newNode);
+		nodesChanged();
 
-			return true;
-		}
-		catch (...)
-		{
-			return false;
-		}
+		return true;
 	}
 	
-	bool PolyLine::addDisplayArcNode(Point<double>& point)
+	bool PolyLine::addNode(Node& node)
 	{
-		if (!displayNodeBlocked)
-		{
-			auto& lastNode = nodes.back();
-			unique_ptr<Node> newDisplaNode = make_unique<ArcNode>(*lastNode, this, point);
-			displayNode.swap(newDisplaNode);
+		nodes.push(node);
+		nodesChanged();
 
-			return true;
-		}
-		return false;
+		return true;
 	}
 
 	bool PolyLine::addArc(Point<double>& point)
 	{
-		try
-		{
-			if (nodes.back()->isFirstNode()) return false;		// arc cannot be made from first node
+		auto arcNode = ArcNode(nodes, point);
+		if (!arcNode.isValid()) return false;
 
-			auto& lastNode = nodes.back();
-			unique_ptr<Node> newArcNode = make_unique<ArcNode>(*lastNode, this, point);
-			nodes.push_back(move(newArcNode));
+		auto newArcNode = arcNode.getNode();
+		nodes.push(newArcNode);
+		nodesChanged();
 
-			return true;
-		}
-		catch (...)
-		{
-			displayNodeBlocked = false;
-			return false;
-		}
+		return true;
 	}
 
 	bool PolyLine::removeLastNode()
 	{
-		displayNodeBlocked = true;
-		displayNode.reset();
-
-		if (nodes.back()->isFirstNode()) return false;			// first node cannot be removed
+		if (nodes.getKindAt(lastNodeIndex()) == NodeKind::First) return false;			// first node cannot be removed
 		
-		nodes.pop_back();
-		displayNodeBlocked = false;
+		nodes.pop();
+		nodesChanged();
 		return true;
 	}
 
-	void PolyLine::generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy)
+	bool PolyLine::restoreNode(NodeKind kind, Point<double>& point)
+	{
+		if (nodes.removedNodesCount() == 0) return false;
+
+		size_t index = nodes.size();
+		auto endPoint = nodes.getEndPointAt(index);
+		if ((nodes.getKindAt(index) != kind) || (endPoint.x != point.x) || (endPoint.y != point.y)) return false;
+
+		nodes.restore();
+		nodesChanged();
+		return true;
+	}
+
+	BoundingBox<double> PolyLine::getBoundingBox()
+	{
+		return nodes.getBoundingBox();
+	}
+
+	void PolyLine::generateVisibleVertexChain(VertexBuffer<double>& vertexBuffer, vector<size_t>& stripEnds, ArcAccuracy accuracy, BoundingBox<double>& area)
+	{
+		nodes.generateVisibleVertexChain(vertexBuffer, stripEnds, accuracy, area);
+	}
+
+	void PolyLine::setTessellationPool(WorkStealingPool* pool)
+	{
+		nodes.setTessellationPool(pool);
+	}
+
+
+	ClosestPoint PolyLine::findClosestPoint(Point<double> point)
+	{
+		return nodes.findClosestPoint(point);
+	}
+
+
+	double PolyLine::getDistance(Point<double> point)
+	{
+		return nodes.findClosestPoint(point).distance;
+	}
+
+
+	void PolyLine::findClosestPoints(const vector<Point<double>>& points, vector<ClosestPoint>& closestPoints)
+	{
+		nodes.findClosestPoints(points, closestPoints);
+	}
+
+
+	void PolyLine::generateVisiblePeakPoints(vector<Point<double>>& peakPoints, BoundingBox<double>& area)
+	{
+		nodes.generateVisiblePeakPoints(peakPoints, area);
+	}
+
+	size_t PolyLine::vertexCount(ArcAccuracy accuracy)
+	{
+		return nodes.vertexCount(accuracy);
+	}
+
+	void PolyLine::generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy)
 	{
-		for (auto& node : nodes)
-			node->generateVertexChain(vertexChain, accuracy);
+		vertexBuffer.reserve(vertexBuffer.size() + vertexCount(accuracy));
 
-		if((!displayNodeBlocked) && displayNode)
-			displayNode->generateVertexChain(vertexChain, accuracy);
+		nodes.generateVertexChain(vertexBuffer, accuracy);
 	}
 
 	
 	void PolyLine::generatePeakPoints(vector<Point<double>>& peakPoints)
 	{
-		for (auto& node : nodes)
-			node->generatePeakPoints(peakPoints);
-		if ((!displayNodeBlocked) && displayNode)
-			displayNode->generatePeakPoints(peakPoints);
+		nodes.generatePeakPoints(peakPoints);
 	}
 	
-	Node& PolyLine::getNodeAt(unsigned int index)
+	NodeStore& PolyLine::getNodes()
 	{
-		return *nodes[index];
+		return nodes;
 	}
 
 	unsigned int PolyLine::lastNodeIndex()
 	{
-		return (nodes.size() - 1);
+		return static_cast<unsigned int>(nodes.size() - 1);
 	}
 }
\ No newline at end of file
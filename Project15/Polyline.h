@@ -1,5 +1,8 @@
 #pragma once
 #include "Primitives.h"
+#include "Tessellation.h"
+#include "ThreadPool.h"
+#include <array>
 #include <vector>
 #include <memory>
 
@@ -13,103 +16,266 @@ namespace obj
 	using std::make_unique;
 
 	class PolyLine;
-	
+	class NodeStore;
+	class PolylineFile;
+
 	// PolyLine is made of nodes, that cam be Linear or Circular, so they're displayed and created in different ways
-	class Node
+	enum class NodeKind : unsigned char
 	{
-	protected:
+		First,														// polyline begins with this node, it's only a point
+		Line,
+		Arc
+	};
+
+
+
+	// Node is a single node taken from NodeStore, or the one that is going to be put there. Arc is used only by arc nodes
+	struct Node
+	{
+		NodeKind kind;
 		Point<double> endPoint;
-	public:
+		Arc arc;
+
 		Node() = default;
-		Node(Point<double>& newPoint);
-		inline Point<double> getEndPoint();
-		
-		virtual inline bool isFirstNode() = 0;
-		virtual inline bool isArc() = 0;
-		virtual void generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy) = 0;	// sets vertexes in vertex chain. Method is used to display polyline on screen. Accuracy is number of section for circle aproximation
-		virtual void generatePeakPoints(vector<Point<double>>&) = 0;									// sets vector of points, that is used to display circles peak points
-	};
+		Node(NodeKind kind, Point<double> endPoint);
+		Node(Point<double> endPoint, Arc& arc);
 
+		inline bool isFirstNode() { return (kind == NodeKind::First); }
+		inline bool isArc() { return (kind == NodeKind::Arc); }
+		unsigned int vertexCount(ArcAccuracy accuracy);											// returns number of vertexes that generateVertexChain would add
+		void generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy);	// sets vertexes in vertex buffer. Accuracy is number of sections per circle or max deviation of arc aproximation
+		void generatePeakPoints(vector<Point<double>>& points);									// sets peak point of arc, so it can be displayed on screen
+	};
 
 
 
 
-	class FirstNode
-		: public Node
+	// ClosestPoint is the answer of distance query: the nearest point of polyline, its distance and the node it belongs to
+	struct ClosestPoint
 	{
-	public:
-		FirstNode(Point<double>& point);
+		Point<double> point;
+		double distance = std::numeric_limits<double>::infinity();
+		size_t nodeIndex = 0;								// the point is on section or arc that leads to this node, 0 when it's the first node
+	};
 
-		inline bool isArc() override;
-		inline bool isFirstNode() override;
 
-		void generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy) override;
-		void generatePeakPoints(vector<Point<double>>&) override { return; };
-	};
 
 
-	
-	class LineNode
-		: public Node
+	// NodeStore keeps nodes in parallel contiguous arrays instead of separate heap objects, so going through long polylines doesn't chase pointers.
+	// Arcs have their own array, in the same order as arc nodes. Vertexes of all nodes are cached in one buffer, only new nodes are tessellated.
+	// Visible parts are cached per chunk instead, in the accuracy they were drawn in, so drawing costs as much as the chunks on screen, however long the polyline is.
+	// Removed nodes stay in arrays after the last node, with their arcs and vertexes, until a new node is pushed. So they can be restored
+	// (redo) without computing anything again
+	class NodeStore
 	{
+		size_t nodesCount = 0;								// nodes in the store, arrays can be longer because of removed nodes
+		vector<NodeKind> kinds;
+		vector<Point<double>> endPoints;
+		vector<unsigned int> arcIndexes;					// index of node's arc in arcs (for other nodes it's number of arcs before them)
+		vector<Arc> arcs;
+		vector<Point<double>> peakPoints;					// peak points of arcs, in the same order as arcs
 
+		VertexBuffer<double> vertexes;						// cached vertexes of the first vertexEnds.size() nodes, generated in tessellationAccuracy
+		vector<size_t> vertexEnds;							// index after the last vertex of every tessellated node
+		ArcAccuracy tessellationAccuracy = 0;
+		WorkStealingPool* tessellationPool = nullptr;		// many new nodes are tessellated and batches of distance queries run on it, when it's set
+		vector<BoundingBox<double>> chunkBoxes;				// box of every chunkSize nodes (removed ones too), with sections that lead to them
+		size_t boxedNodesCount = 0;							// nodes of arrays that are already in chunk boxes
+		vector<BoundingBox<double>> blockBoxes;				// box of every blockSize nodes, boxes of blocks, chunks and groups make the hierarchy for distance queries
+		vector<BoundingBox<double>> groupBoxes;				// box of every chunkGroupSize chunks
+
+		struct ChunkVertexes								// vertexes of one chunk, made when the chunk was visible
+		{
+			VertexBuffer<double> vertexes;
+			vector<unsigned int> vertexEnds;				// index after the last vertex of every tessellated node of chunk, removed nodes too
+			ArcAccuracy accuracy = 0;
+			size_t lastFrame = 0;							// the last call of generateVisibleVertexChain that drew the chunk
+		};
+		vector<ChunkVertexes> chunkVertexes;
+		size_t chunkVertexesCount = 0;						// vertexes in all chunks, they're freed above maxChunkVertexes
+		size_t visibleFrame = 0;							// calls of generateVisibleVertexChain
+		vector<size_t> staleChunks;							// visible chunks that have to be tessellated in this call
+
+		struct QueuedBox									// box waiting for distance query, the nearest one is looked into first
+		{
+			double distance;								// squared distance from query point
+			unsigned char level;							// 0 for block, 1 for chunk, 2 for group
+			size_t index;
+
+			inline bool operator>(const QueuedBox& box) const { return distance > box.distance; }
+		};
+
+		inline size_t arcsBefore(size_t index) { return (index < arcIndexes.size()) ? arcIndexes[index] : arcs.size(); }
+		inline size_t chunksCount() { return (nodesCount + chunkSize - 1) / chunkSize; }
+		void forgetRemovedNodes();							// removed nodes can't be restored after this
+		void tessellate(ArcAccuracy accuracy);				// brings cache up to date. All nodes are generated again only when accuracy changes
+		void tessellateParallel(ArcAccuracy accuracy);		// the same for new nodes on pool: vertex counts, their prefix sum, then every node writes to its own place
+		void tessellateChunk(size_t chunk, ArcAccuracy accuracy);	// brings vertexes of chunk up to date, only chunk's own cache is written, so chunks can be made in parallel
+		void tessellateVisibleChunks(ArcAccuracy accuracy);	// tessellates staleChunks, then frees chunks that weren't drawn when there are too many vertexes
+		void addToChunkBox(size_t index);					// extends box of node's chunk by the section or arc that ends in the node
+		void updateChunkBoxes();							// brings boxes up to date, only nodes added since the last call are checked
+		void findClosestPointInNode(size_t index, Point<double>& point, ClosestPoint& closest);	// closest.distance is squared here
+		void findClosestPoint(Point<double>& point, ClosestPoint& closest, vector<QueuedBox>& boxQueue);	// only reads arrays, boxes have to be up to date
+
+		friend class PolylineFile;							// reads and writes arrays directly
 	public:
-		LineNode(Point<double> newPoint);
+		static const size_t chunkSize = 256;				// nodes are culled in chunks, one box per node would cost more than drawing short sections
+		static const size_t blockSize = 16;
+		static const size_t chunkGroupSize = 16;
+		static const size_t queryGrain = 1024;				// queries in one range of pool, smaller batches run on the calling thread
+		static const size_t minParallelNodes = 4096;		// fewer new nodes are tessellated on the calling thread
+		static const size_t tessellationGrain = 512;		// nodes in one range of pool
+		static const size_t maxChunkVertexes = 1 << 22;		// vertexes of chunks out of view are freed above this
+
+		NodeStore() = default;
 
-		inline bool isArc() override;
-		inline bool isFirstNode() override;	
-		
-		void generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy) override;
-		void generatePeakPoints(vector<Point<double>>&) override { return; }
+		inline size_t size() { return nodesCount; }
+		inline size_t removedNodesCount() { return kinds.size() - nodesCount; }					// number of nodes that can be restored. Getters below work for them at index size()
+		inline NodeKind getKindAt(size_t index) { return kinds[index]; }
+		inline Point<double> getEndPointAt(size_t index) { return endPoints[index]; }
+		inline Arc& getArcAt(size_t index) { return arcs[arcIndexes[index]]; }					// only for arc nodes
+		inline Point<double> getPeakPointAt(size_t index) { return peakPoints[arcIndexes[index]]; }	// only for arc nodes
+		void push(Node& node);												// adds node at the end, removed nodes are forgotten
+		Node pop();															// removes the last node and returns it, it can be restored later
+		void restore();														// brings back the last removed node, only when removedNodesCount() > 0
+		size_t vertexCount(ArcAccuracy accuracy);							// returns number of vertexes that generateVertexChain would add
+		void generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy);
+		void generatePeakPoints(vector<Point<double>>& points);
+		inline void setTessellationPool(WorkStealingPool* pool) { tessellationPool = pool; }	// nullptr turns parallel tessellation and queries off
+		BoundingBox<double> getBoundingBox();								// box around all nodes. After undo it can be bigger than the polyline, until the next node is pushed
+		bool generateVisibleVertexChain(VertexBuffer<double>& vertexBuffer, vector<size_t>& stripEnds, ArcAccuracy accuracy, BoundingBox<double>& area);
+																			// adds vertexes of chunks that intersect area, neighbouring chunks make one strip. stripEnds gets
+																			// index after the last vertex of every strip. Returns true when the last strip ends in the last node
+		void generateVisiblePeakPoints(vector<Point<double>>& points, BoundingBox<double>& area);
+		ClosestPoint findClosestPoint(Point<double> point);				// finds the nearest point on sections and true arcs (not their polygons)
+		void findClosestPoints(const vector<Point<double>>& points, vector<ClosestPoint>& closestPoints);
+																			// answers many queries on pool, closestPoints gets one answer per point
 	};
 
 
 
 
+	// ArcError tells why tangent arc can't be made. Arcs fail often (ex. cursor on the tangent line), so it's returned, not thrown
+	enum class ArcError : unsigned char
+	{
+		None,
+		FirstNodeArc,										// polyline has only its first node, there's no direction to be tangent to
+		ZeroLengthSection,									// the last section, or the section from the end of polyline to the new point, has zero length
+		ParallelLines										// radius line and axis line don't cross, the new point lies on the tangent line
+	};
+
+
+
+	// ArcNode finds the arc that is tangent to the last node of polyline and ends in the new point
 	class ArcNode
-		: public Node
 	{
-		unique_ptr<Arc> arc;
+		Point<double> endPoint;
+		Arc arc;
+		ArcError error = ArcError::None;
 
 		// arc's center is placed on the intersection of radius line (which is perpendicular to previous node) and axis node (that is perpendicular to new node)
-		void setAxisLine(Point<double>& beginPoint, Point<double>& endPoint, unique_ptr<LineInterface>& axisLine);
-		unique_ptr<Arc> createArcAfterSection(Point<double>& previousNodeBeginPt, Point<double>& previousNodeEndPt, Point<double>& newPoint);
-		unique_ptr<Arc> createArcAfterArc(Point<double>& previousNodeCenter, Point<double>& previousSectionEndPoint, Point<double>& newSectionEndpoint, Node& previousNode);
+		Line setAxisLine(Point<double>& beginPoint, Point<double>& endPoint);
+		ArcError createArcAfterSection(Point<double>& previousNodeBeginPt, Point<double>& previousNodeEndPt, Point<double>& newPoint);	// sets arc, when there's no error
+		ArcError createArcAfterArc(Point<double>& previousNodeCenter, Point<double>& previousSectionEndPoint, Point<double>& newSectionEndpoint, Point<double>& previousNodePeak);
 		bool arcWillBeClockWiseAfterSection(Point<double>& previousNodeBeginPt, Point<double>& arcFirstPoint, Point<double>& arcCenter);								// used when previous node was straighnt line
 		bool arcWillBeClockWiseAfterArc(Point<double>& previousNodeCenter, Point<double>& previousNodePeak, Point<double>& arcFirstPoint, Point<double>& newPoint);		// used when previous nodw was an arc
 	public:
-		ArcNode(Node& previousNode, PolyLine* polyLine, Point<double> newPoint);
-		inline bool isArc() override;
-		inline bool isFirstNode() override;
-		inline Point<double> arcCenter();
-		inline Point<double> getPeakPoint();
-		void generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy) override;		// sets vertexes in vertex chain so it can be displayed on screen in given accuracy (vertexes per whole 360 deg circle)
-		void generatePeakPoints(vector<Point<double>>& points) override;								// sets peak points of arc so it can be displayed on screen
+		ArcNode(NodeStore& nodes, Point<double> newPoint);				// never throws, getError tells whether arc could be made
+		inline ArcError getError() { return error; }
+		inline bool isValid() { return (error == ArcError::None); }
+		Node getNode();													// only for valid arc node
+	};
+
+
+
+	// PreviewStatus tells what preview evaluator has done with the point under cursor
+	enum class PreviewStatus : unsigned char
+	{
+		Shown,
+		NoTangent,											// polyline has no direction at its end (only the first node, or the last section has zero length), arc can't be tangent
+		OnTangentLine										// point lies on the line the polyline ends with (or on its end), the arc would be a straight line
+	};
+
+
+
+	// PreviewTangent is the end of polyline that preview starts from. PolyLine computes it once, when its nodes change, so a mouse move
+	// doesn't look into nodes. It's all that polyline keeps for preview, the node itself belongs to the one who draws it (see PolyLineControler)
+	struct PreviewTangent
+	{
+		Point<double> beginPoint;							// end point of the last node
+		Vector<double> tangent{ 0, 0 };						// direction of polyline in beginPoint, zero when it has none
+
+		void update(NodeStore& nodes);
+	};
+
+
+
+	// PreviewNode is the rubber-band node that follows the cursor. A mouse move only solves the arc tangent to PreviewTangent (center lies
+	// on normal of tangent, as far from both ends) and writes its vertexes to a fixed buffer. Degenerate points are reported by status
+	// and hide the preview, nothing is thrown and nothing is allocated. Only the polyline being drawn has one, so the buffer isn't in PolyLine
+	class PreviewNode
+	{
+	public:
+		static const size_t capacity = 256;					// the most vertexes of preview, bigger arcs are divided into fewer sections
+	private:
+		NodeKind kind = NodeKind::Line;
+		bool shown = false;
+		Point<double> beginPoint;							// end point of the last node
+		Point<double> endPoint;
+		Arc arc;											// only for arc preview
+
+		std::array<double, capacity> xs;					// vertexes after beginPoint, up to endPoint
+		std::array<double, capacity> ys;
+		size_t vertexesCount = 0;
+		ArcAccuracy vertexesAccuracy = 0;					// accuracy of vertexes in buffer, they're valid only when vertexesCount > 0
+
+		void generateVertexes(ArcAccuracy accuracy);		// fills buffer, when it isn't made in this accuracy already
+	public:
+		PreviewStatus setLine(PreviewTangent& end, Point<double> point);	// section from the last node to point
+		PreviewStatus setArc(PreviewTangent& end, Point<double> point);	// arc tangent to the last node, ending in point
+		inline void hide() { shown = false; }
+		inline bool isShown() { return shown; }
+		inline bool isArc() { return shown && (kind == NodeKind::Arc); }
+		inline Point<double> getBeginPoint() { return beginPoint; }
+		inline Point<double> getPeakPoint() { return arc.getPeakPoint(); }	// only for arc preview
+		BoundingBox<double> getBoundingBox();				// box of preview with its begin point
+		size_t vertexCount(ArcAccuracy accuracy);			// vertexes without begin point, as Node::vertexCount
+		void generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy);	// adds vertexes after begin point
+		void generatePeakPoints(vector<Point<double>>& points);
 	};
 
 
 
 	class PolyLine
 	{
-		vector<unique_ptr<Node>> nodes;	
-		unique_ptr<Node> displayNode;						// used to show the shape of polyline after mouse move
-		bool displayNodeBlocked;							// flag that is used to block gl functions that are running parallel
-		
+		NodeStore nodes;
+		PreviewTangent previewTangent;						// end of polyline, where preview of the next node starts
+
+		void nodesChanged();								// updates tangent of preview
+
 	public:
 		PolyLine(Point<double>& point);						// creates Polyline with first node in given point
+		PolyLine(NodeStore&& nodes);						// creates Polyline from nodes, the first one has to be NodeKind::First
 		~PolyLine();
 		PolyLine(const PolyLine&) = delete;
-		
-		void blockDisplayNode();		
-		void unBlockDisplayNode();
+
 		bool addLine(Point<double>& point);					// adds new vertex after given point
-		bool addArc(Point<double>& point);					// adds new vertex at the end of polyline
-		bool addDisplayLineNode(Point<double>& point);		// adds DISPLAY node after mouse move
-		bool addDisplayArcNode(Point<double>& point);		// adds DISPLAY node after mouse move
-		inline Node& getNodeAt(unsigned int index);			// returns node at given index
-		inline unsigned int lastNodeIndex();				// returns last real nodes index
+		bool addArc(Point<double>& point);					// adds new vertex at the end of polyline, returns false when arc can't be made (see ArcError)
+		bool addNode(Node& node);							// adds ready node (ex. read from file) as it is, it isn't made tangent to the previous one
+		NodeStore& getNodes();								// returns nodes of polyline
+		inline PreviewTangent& getPreviewTangent() { return previewTangent; }
+		void setTessellationPool(WorkStealingPool* pool);	// long polylines are tessellated and queried on pool, the results are the same as without it. nullptr turns it off
+		unsigned int lastNodeIndex();						// returns last real nodes index
 		bool removeLastNode();								// returns false if the last node is PolyLineFirstNode, that cannot be removed
+		bool restoreNode(NodeKind kind, Point<double>& point);	// brings back the last removed node, when it's the one of given kind and end point
+		BoundingBox<double> getBoundingBox();				// box around nodes
+		void generateVisibleVertexChain(VertexBuffer<double>& vertexBuffer, vector<size_t>& stripEnds, ArcAccuracy accuracy, BoundingBox<double>& area);	// generates only parts of polyline that can be seen in area, as separate line strips
+		void generateVisiblePeakPoints(vector<Point<double>>& peakPoints, BoundingBox<double>& area);
+		ClosestPoint findClosestPoint(Point<double> point);												// nearest point of polyline with true arcs
+		double getDistance(Point<double> point);														// distance from point to polyline
+		void findClosestPoints(const vector<Point<double>>& points, vector<ClosestPoint>& closestPoints);	// the same for many points, on tessellation pool when it's set
 		void generatePeakPoints(vector<Point<double>>& peakPoints);								// generates peak points on every arc and sets them to the vector
-		void generateVertexChain(VertexChain<double>& vertexChain, unsigned int accuracy);		// generates polyline with given accuracy, so it can be displayed
+		size_t vertexCount(ArcAccuracy accuracy);												// returns number of vertexes that generateVertexChain would add, used as a size hint
+		void generateVertexChain(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy);	// generates polyline with given accuracy, so it can be displayed
 	};
 }
@@ -0,0 +1,374 @@
+#include "PolylineControler.h"
+#include <cmath>
+
+
+
+namespace controler
+{
+	// Functors
+	// AddLine
+
+	bool AddLine::operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine)
+	{
+		return polyLine->addLine(point);
+	}
+
+
+
+	// AddArc
+
+	bool AddArc::operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) 
+	{
+		return polyLine->addArc(point);
+	}
+
+
+
+
+
+	// PolyLineControler
+
+	PolyLineControler::PolyLineControler(HistoryHandler& historyHandler, Document& document)
+		:	currentPolyLine(),
+			addArc(),
+			addLine(),
+			addNodeFunctor(&addLine),
+			actualizeArc(),
+			actualizeLine(),
+			actualize(&actualizeLine),
+			historyHandler(historyHandler),
+			document(document)
+	{
+		historyHandler.setPolylineControler(this);
+	}
+
+
+	bool PolyLineControler::startAddingArcs()
+	{
+		if (!polyLineIsAttached())
+		{
+			actualize = &actualizeLine;
+			addNodeFunctor = &addLine;
+			return false;
+		}
+
+		if (currentPolyLine->lastNodeIndex() == 0)		// if last node is first node adding arc is impossible
+		{
+			actualize = &actualizeLine;
+			addNodeFunctor = &addLine;
+			return false;			
+		}
+
+		actualize = &actualizeArc;
+		addNodeFunctor = &addArc;
+		return true;
+	}
+
+	bool PolyLineControler::startAddingLines()
+	{
+		actualize = &actualizeLine;
+		addNodeFunctor = &addLine;
+		return true;
+	}
+
+	void PolyLineControler::setArcAproximationAccuracy(unsigned int accuracy)
+	{
+		this->arcApproximationAccuracy = accuracy;
+		revision++;
+	}
+
+	void PolyLineControler::setArcMaxDeviation(double maxDeviation)
+	{
+		auto accuracy = ArcAccuracy::fromDeviation(maxDeviation);
+		if (accuracy == arcApproximationAccuracy) return;		// cached vertexes stay valid
+
+		arcApproximationAccuracy = accuracy;
+		revision++;
+	}
+
+	void PolyLineControler::setArcMaxScreenDeviation(double maxDeviation, double pixelSize)
+	{
+		double levelPixelSize = std::exp2(std::floor(std::log2(pixelSize)));		// pixel size is rounded down to a power of two, so zoom steps within one level keep the same vertexes
+		setArcMaxDeviation(maxDeviation * levelPixelSize);
+	}
+	
+	bool PolyLineControler::polyLineIsAttached()
+	{
+		return (currentPolyLine != nullptr);
+	}
+
+	uint32_t PolyLineControler::currentPolyLineId()
+	{
+		return static_cast<uint32_t>(document.size());			// finished polyline is appended to document
+	}
+
+	void PolyLineControler::forgetRemovedSelection()
+	{
+		if (!nodeSelected || (selectedNode.polyLine < currentPolyLineId())) return;	// polylines in document don't lose nodes
+		if (polyLineIsAttached() && (selectedNode.polyLine == currentPolyLineId()) && (selectedNode.nodeIndex <= currentPolyLine->lastNodeIndex())) return;
+		nodeSelected = false;
+	}
+
+	void PolyLineControler::removePolyLine()
+	{
+		startAddingLines();
+		if (polyLineIsAttached() && (currentPolyLine->lastNodeIndex() > 0))		// polyline with only the first node is just a point, it isn't kept
+			document.add(move(currentPolyLine));
+		else if (polyLineIsAttached())
+			snapIndex.removeLast();
+		currentPolyLine.reset();
+		preview.hide();
+		forgetRemovedSelection();
+		revision++;
+	}
+
+
+	void PolyLineControler::actualizePolyLine(Point<double>& mousePosition)
+	{
+		if (polyLineIsAttached())
+		{
+			(*actualize)(mousePosition, currentPolyLine, preview);
+			previewRevision++;
+		}
+	}
+
+
+	void PolyLineControler::addNode(Point<double>& point)
+	{
+		if (polyLineIsAttached())
+		{
+			preview.hide();											// display node is shown again after the next mouse move
+			bool nodeAdded = (*addNodeFunctor)(point, currentPolyLine);
+			if (nodeAdded)											// only added nodes go to history, so undo always removes the node of its event
+			{
+				snapIndex.addNode(currentPolyLine->getNodes(), currentPolyLine->lastNodeIndex(), currentPolyLineId());
+				auto newEvent = Event(currentPolyLine->getNodes().getKindAt(currentPolyLine->lastNodeIndex()), point);
+				historyHandler.addEvent(newEvent);
+			}
+		}
+		else
+		{
+			auto newPolyline = make_unique<PolyLine>(point);
+			currentPolyLine.swap(newPolyline);					// current polyline is set to just created newPolyline
+			currentPolyLine->setTessellationPool(&document.getTessellationPool());
+			snapIndex.addNode(currentPolyLine->getNodes(), 0, currentPolyLineId());
+		}
+		revision++;
+	}
+
+
+	void PolyLineControler::redoNode(NodeKind kind, Point<double>& point)
+	{
+		preview.hide();
+		if (polyLineIsAttached())
+		{
+			auto nodesCount = currentPolyLine->lastNodeIndex();
+			bool nodeRestored = currentPolyLine->restoreNode(kind, point);		// undone node is moved back with its arc and vertexes
+			if (!nodeRestored)
+			{
+				if (kind == NodeKind::Arc)
+					currentPolyLine->addArc(point);
+				else
+					currentPolyLine->addLine(point);
+			}
+			if (currentPolyLine->lastNodeIndex() > nodesCount)
+				snapIndex.addNode(currentPolyLine->getNodes(), currentPolyLine->lastNodeIndex(), currentPolyLineId());
+		}
+		else
+		{
+			auto newPolyline = make_unique<PolyLine>(point);
+			currentPolyLine.swap(newPolyline);					// current polyline is set to just created newPolyline
+			currentPolyLine->setTessellationPool(&document.getTessellationPool());
+			snapIndex.addNode(currentPolyLine->getNodes(), 0, currentPolyLineId());
+		}
+		revision++;
+	}
+
+
+	void PolyLineControler::removeNode()
+	{
+		preview.hide();
+		if (polyLineIsAttached())
+		{
+			auto kind = currentPolyLine->getNodes().getKindAt(currentPolyLine->lastNodeIndex());
+			bool nodeRemoved = currentPolyLine->removeLastNode();
+
+			if(!nodeRemoved)
+				currentPolyLine.reset(nullptr);					// if there's only one node left, the whole polyline is going to be removed
+			snapIndex.removeLast(SnapIndex::nodePointsCount(kind));
+			forgetRemovedSelection();
+		}
+		revision++;
+	}
+
+
+	void PolyLineControler::generateVertexChain(VertexBuffer<double>& vertexBuffer)
+	{
+		if (polyLineIsAttached())
+			currentPolyLine->generateVertexChain(vertexBuffer, arcApproximationAccuracy);
+	}
+
+
+	void PolyLineControler::generatePeakPoints(vector<Point<double>>& peakPoints)
+	{
+		if (polyLineIsAttached())
+			currentPolyLine->generatePeakPoints(peakPoints);
+	}
+
+
+	void PolyLineControler::generateVisibleVertexChain(VertexBuffer<double>& vertexBuffer, vector<size_t>& stripEnds, BoundingBox<double>& area)
+	{
+		if (polyLineIsAttached())
+			currentPolyLine->getNodes().generateVisibleVertexChain(vertexBuffer, stripEnds, arcApproximationAccuracy, area);
+	}
+
+
+	void PolyLineControler::generateVisiblePeakPoints(vector<Point<double>>& peakPoints, BoundingBox<double>& area)
+	{
+		if (polyLineIsAttached())
+			currentPolyLine->getNodes().generateVisiblePeakPoints(peakPoints, area);
+	}
+
+
+	bool PolyLineControler::generatePreview(VertexBuffer<double>& vertexBuffer, vector<Point<double>>& peakPoints)
+	{
+		if (!polyLineIsAttached() || !preview.isShown()) return false;
+
+		vertexBuffer.add(preview.getBeginPoint());
+		preview.generateVertexChain(vertexBuffer, arcApproximationAccuracy);
+		preview.generatePeakPoints(peakPoints);
+		return true;
+	}
+
+
+	bool PolyLineControler::findSnapPoint(Point<double>& point, double radius, SnapPoint& snapPoint)
+	{
+		return snapIndex.findNearest(point, radius, snapPoint);
+	}
+
+
+	Point<double> PolyLineControler::snap(Point<double>& point, double radius)
+	{
+		SnapPoint snapPoint;
+		if (snappingEnabled && snapIndex.findNearest(point, radius, snapPoint))
+			return snapPoint.point;
+		return point;
+	}
+
+
+	bool PolyLineControler::findNode(Point<double>& point, double radius, SnapPoint& node)
+	{
+		return snapIndex.findNode(point, radius, node);
+	}
+
+
+	bool PolyLineControler::selectNode(Point<double>& point, double radius)
+	{
+		nodeSelected = snapIndex.findNode(point, radius, selectedNode);
+		return nodeSelected;
+	}
+
+
+	bool PolyLineControler::getSelectedNode(SnapPoint& node)
+	{
+		if (nodeSelected) node = selectedNode;
+		return nodeSelected;
+	}
+
+
+	void PolyLineControler::switchSnapping() { snappingEnabled = !snappingEnabled; }
+	bool PolyLineControler::snappingIsEnabled() { return snappingEnabled; }
+	unsigned long PolyLineControler::getRevision() { return revision; }
+	unsigned long PolyLineControler::getPreviewRevision() { return previewRevision; }
+	Document& PolyLineControler::getDocument() { return document; }
+	ArcAccuracy PolyLineControler::getArcAccuracy() { return arcApproximationAccuracy; }
+
+
+
+
+	// Event
+	
+	Event::Event(NodeKind kind, Point<double>& point)
+		:	kind(kind),
+			point(point)
+	{	}
+
+
+	void Event::undo(PolyLineControler& polyLineControler)
+	{
+		polyLineControler.removeNode();
+	}
+
+
+	void Event::redo(PolyLineControler& polyLineControler)
+	{
+		polyLineControler.redoNode(kind, point);
+	}
+
+
+
+	// History Handler
+
+	HistoryHandler::HistoryHandler(size_t depth)
+		:	events(depth > 0 ? depth : 1)
+	{	}
+
+	
+	void HistoryHandler::setPolylineControler(PolyLineControler* polyLineContrl) { polyLineControler = polyLineContrl; }
+
+
+	Event& HistoryHandler::eventAt(size_t position)
+	{
+		size_t index = firstEventIndex + position;
+		if (index >= events.size()) index -= events.size();
+		return events[index];
+	}
+
+	
+	bool HistoryHandler::canUndo()
+	{
+		return (doneEventsCount > 0);
+	}
+
+	
+	bool HistoryHandler::canRedo()
+	{
+		return (doneEventsCount < eventsCount);
+	}
+
+	
+	void HistoryHandler::undo()
+	{
+		if (canUndo())
+		{
+			doneEventsCount--;
+			eventAt(doneEventsCount).undo(*polyLineControler);
+		}
+	}
+
+	
+	void HistoryHandler::redo()
+	{
+		if (canRedo())
+		{
+			eventAt(doneEventsCount).redo(*polyLineControler);
+			doneEventsCount++;
+		}
+	}
+
+	
+	void HistoryHandler::addEvent(Event& currentEvent)
+	{
+		eventsCount = doneEventsCount;								// events after the current one can't be redone anymore
+
+		if (eventsCount == events.size())							// ring is full, the oldest event is forgotten
+		{
+			firstEventIndex = (firstEventIndex + 1 == events.size()) ? 0 : firstEventIndex + 1;
+			eventsCount--;
+		}
+
+		eventAt(eventsCount) = currentEvent;
+		eventsCount++;
+		doneEventsCount = eventsCount;
+	}
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include "Primitives.h"
+#include "Polyline.h"
+#include "Document.h"
+#include "Snapping.h"
+#include <memory>
+
+
+
+namespace controler
+{ 
+	using namespace primitives;
+	using namespace obj;
+	using std::make_unique;
+	using std::unique_ptr;
+	using std::move;
+
+
+	class PolyLineControler;
+	class HistoryHandler;
+
+
+
+	// this functors is called when its needed to edit polyline. History doesn't keep them, it keeps kinds of added nodes (see Event)
+	struct AddNodeFunctor
+	{
+		virtual bool operator()(Point<double>&, unique_ptr<PolyLine>&) = 0;
+		virtual ~AddNodeFunctor() = default;
+	};
+
+	struct AddLine
+		: public AddNodeFunctor
+	{
+		AddLine() = default;
+		~AddLine() = default;
+		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) override;
+	};
+
+	struct AddArc
+		: public AddNodeFunctor
+	{
+		AddArc() = default;
+		~AddArc() = default;
+		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine) override;
+	};
+
+	// below functors are called when it's need to actualize the shape of polyline, they set preview from the end of polyline to point
+	struct Actualize
+	{
+		virtual bool operator()(Point<double>&, unique_ptr<PolyLine>&, PreviewNode&) = 0;
+	};
+
+	struct ActualizeLine
+		: public Actualize
+	{
+		ActualizeLine() = default;
+		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine, PreviewNode& preview) override
+		{
+			return (preview.setLine(polyLine->getPreviewTangent(), point) == PreviewStatus::Shown);
+		}
+	};
+
+	struct ActualizArc
+		: public Actualize
+	{
+		ActualizArc() = default;
+		bool operator()(Point<double>& point, unique_ptr<PolyLine>& polyLine, PreviewNode& preview) override
+		{
+			return (preview.setArc(polyLine->getPreviewTangent(), point) == PreviewStatus::Shown);	// preview is hidden when arc can't be made there
+		}
+	};
+
+
+
+
+	// Event is a plain record of added node: its kind and the point that was clicked. It's copied without any allocation
+	struct Event
+	{
+		NodeKind kind;
+		Point<double> point;
+
+		Event() = default;
+		Event(NodeKind kind, Point<double>& point);
+		void undo(PolyLineControler& polyLineControler);									// removes the last node
+		void redo(PolyLineControler& polyLineControler);									// adds node of the same kind in the same point again
+	};
+
+
+
+
+	// HistoryHandler keeps events in a ring of fixed size, allocated once. When it's full the oldest event is forgotten,
+	// so adding, undoing and redoing are O(1) and the history never grows above its depth
+	class HistoryHandler
+	{
+		PolyLineControler* polyLineControler;
+		vector<Event> events;											// ring, the oldest event is at firstEventIndex
+		size_t firstEventIndex = 0;
+		size_t eventsCount = 0;											// events that can be undone or redone
+		size_t doneEventsCount = 0;										// events that can be undone, the rest can be redone
+
+		inline Event& eventAt(size_t position);							// returns event at position counted from the oldest one
+	public:
+		static const size_t defaultDepth = 10000;
+
+		HistoryHandler(size_t depth = defaultDepth);					// depth is the number of events that can be undone
+		bool canUndo();													// returns true when undo operation is possible
+		bool canRedo();													// returns true when redo operation is possible
+		void undo();													// if possible calls undo method in current functor
+		void redo();													// if possible calls redo method in current functor
+		void addEvent(Event& currentEvent);								// adds event after the current one, events that could be redone are forgotten
+		inline void setPolylineControler(PolyLineControler*);			// sets polyLineControler pointer
+	};
+
+
+
+
+
+
+	class PolyLineControler
+	{
+		AddLine addLine;
+		AddArc addArc;
+		AddNodeFunctor* addNodeFunctor;							// it points to addLine or addArc, depending on what type of node is wanted to be add
+
+		ActualizeLine actualizeLine;
+		ActualizArc actualizeArc;
+		Actualize* actualize;									// it points to actualizeArc or actualizeLine. These functors are adding display node to polyline
+
+		HistoryHandler& historyHandler;
+		Document& document;										// finished polylines go there
+		SnapIndex snapIndex;									// points of all drawn nodes, finished polylines keep theirs
+		bool snappingEnabled = true;
+		SnapPoint selectedNode;									// end point of the node selected under cursor
+		bool nodeSelected = false;
+		unique_ptr<PolyLine> currentPolyLine;
+		PreviewNode preview;									// display node of current polyline, hidden after every change of its nodes
+		unsigned long revision = 0;								// rises after every change of polyline shape, so displayed vertexes are regenerated only when they're outdated
+		unsigned long previewRevision = 0;						// rises after every mouse move, only display node is generated again then
+		ArcAccuracy arcApproximationAccuracy = 64;				// approximation of arc. It's a number of vertxes in polygon that imitates an arc. If it's set to ex. 100, there would be 100 sections around whole 360 degree arc
+																// it can be also the biggest distance between arc and polygon, then small arcs get less vertexes than big ones
+
+		inline bool polyLineIsAttached();						// returns true when some polyline is attached to the class
+		uint32_t currentPolyLineId();							// id that polyline being drawn gets in document
+		void forgetRemovedSelection();							// unselects node that isn't in polylines anymore (ex. after undo)
+	public:
+		PolyLineControler(HistoryHandler& historyHandl, Document& document);
+		void removePolyLine();																	// finishes drawing, polyline is moved to document
+		bool startAddingArcs();																	// sets addNodeFunctor for arcs
+		bool startAddingLines();																// sets addNodeFunctor for lines
+		void addNode(Point<double>& point);	
+		void redoNode(NodeKind kind, Point<double>& point);										// called on redo event
+		void removeNode();
+		void actualizePolyLine(Point<double>& mousePosition);										// sets the shape of polyline so it can be displayed
+		void generateVertexChain(VertexBuffer<double>& vertexBuffer);							// generates the "multi xertex line" that would be displayed on screen
+		void generatePeakPoints(vector<Point<double>>& peakPoints);								// generates dots on peek of every arc
+		void generateVisibleVertexChain(VertexBuffer<double>& vertexBuffer, vector<size_t>& stripEnds, BoundingBox<double>& area);	// generates only parts that can be seen in area (see NodeStore), without display node
+		void generateVisiblePeakPoints(vector<Point<double>>& peakPoints, BoundingBox<double>& area);
+		bool generatePreview(VertexBuffer<double>& vertexBuffer, vector<Point<double>>& peakPoints);	// generates display node alone, returns false when there's none
+		unsigned long getRevision();															// returns number that changes whenever generated vertexes would change
+		unsigned long getPreviewRevision();														// the same for display node, it changes after mouse moves too
+		bool findSnapPoint(Point<double>& point, double radius, SnapPoint& snapPoint);			// finds the nearest end point, arc center or peak point within radius
+		Point<double> snap(Point<double>& point, double radius);								// returns the nearest snap point within radius, or the same point when snapping is off
+		bool findNode(Point<double>& point, double radius, SnapPoint& node);					// finds the node whose end point is the nearest within radius, in any polyline
+		bool selectNode(Point<double>& point, double radius);									// selects the node that findNode finds, selection is cleared when there's none
+		bool getSelectedNode(SnapPoint& node);													// returns false when no node is selected
+		void switchSnapping();
+		bool snappingIsEnabled();
+		Document& getDocument();
+		ArcAccuracy getArcAccuracy();
+		inline void setArcAproximationAccuracy(unsigned int accuracy);
+		void setArcMaxDeviation(double maxDeviation);											// arcs are divided so they're never further than maxDeviation from polygon (model units)
+		void setArcMaxScreenDeviation(double maxDeviation, double pixelSize);					// the same in pixels, pixelSize is the length of one pixel in model units (rounded down to a power of two)
+	};
+}
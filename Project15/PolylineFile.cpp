@@ -0,0 +1,339 @@
+#include "PolylineFile.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+
+namespace obj
+{
+	static_assert(sizeof(NodeKind) == 1, "node kinds are stored as single bytes");
+	static_assert(sizeof(Point<double>) == 2 * sizeof(double), "end points are copied as x, y pairs");
+	static_assert(sizeof(PolylineFile::Header) == 48, "header has no padding");
+
+
+	const char PolylineFile::magic[8] = { 'P', 'O', 'L', 'Y', 'L', 'I', 'N', 'E' };
+
+
+	static bool hostIsLittleEndian()
+	{
+		const uint16_t value = 1;
+		unsigned char firstByte;
+		std::memcpy(&firstByte, &value, 1);
+		return (firstByte == 1);
+	}
+
+
+	static size_t padded(size_t bytes)							// sections begin at multiples of 8 bytes
+	{
+		return (bytes + 7) & ~static_cast<size_t>(7);
+	}
+
+
+	static size_t sectionsSize(size_t nodesCount, size_t arcsCount)
+	{
+		return padded(nodesCount) + 2 * sizeof(double) * nodesCount + 7 * sizeof(double) * arcsCount + padded(arcsCount);
+	}
+
+
+
+
+	// Checksum is computed over 64 bit words. Four words are mixed independently, so multiplications don't wait for each other,
+	// and lanes are joined at the end. Words are counted through all added blocks, so the result doesn't depend on how data is split
+
+	class Checksum
+	{
+		static const uint64_t prime = 0x100000001b3ULL;
+		uint64_t lanes[4] = { 0xcbf29ce484222325ULL, 0x84222325cbf29ce4ULL, 0x9e3779b97f4a7c15ULL, 0x7f4a7c159e3779b9ULL };
+		uint64_t wordsCount = 0;
+
+	public:
+		void add(const void* data, size_t bytes)				// bytes is a multiple of 8
+		{
+			const unsigned char* bytePointer = static_cast<const unsigned char*>(data);
+			size_t words = bytes / 8;
+			size_t i = 0;
+
+			for (; (i < words) && (wordsCount % 4 != 0); i++, wordsCount++)
+				addWord(bytePointer + 8 * i, wordsCount % 4);
+
+			for (; i + 4 <= words; i += 4, wordsCount += 4)
+				for (unsigned int lane = 0; lane < 4; lane++)
+					addWord(bytePointer + 8 * (i + lane), lane);
+
+			for (; i < words; i++, wordsCount++)
+				addWord(bytePointer + 8 * i, wordsCount % 4);
+		}
+
+		uint64_t getValue()
+		{
+			uint64_t value = wordsCount;
+			for (auto lane : lanes)
+				value = (value ^ lane) * prime;
+			return value;
+		}
+
+	private:
+		inline void addWord(const unsigned char* word, unsigned int lane)
+		{
+			uint64_t value;
+			std::memcpy(&value, word, 8);
+			lanes[lane] = (lanes[lane] ^ value) * prime;
+		}
+	};
+
+
+
+
+	// MappedFile maps the whole file into memory for reading, it's unmapped in destructor
+
+	class MappedFile
+	{
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+#ifdef _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#endif
+
+	public:
+		MappedFile(const string& path)
+		{
+#ifdef _WIN32
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return;
+
+			LARGE_INTEGER fileSize;
+			if ((!GetFileSizeEx(file, &fileSize)) || (fileSize.QuadPart == 0)) return;
+
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping == nullptr) return;
+
+			data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (data != nullptr) size = static_cast<size_t>(fileSize.QuadPart);
+#else
+			int file = open(path.c_str(), O_RDONLY);
+			if (file < 0) return;
+
+			struct stat fileStatus;
+			if ((fstat(file, &fileStatus) == 0) && (fileStatus.st_size > 0))
+			{
+#ifdef MAP_POPULATE
+				const int flags = MAP_PRIVATE | MAP_POPULATE;						// pages are mapped at once, not one page fault at a time
+#else
+				const int flags = MAP_PRIVATE;
+#endif
+				void* mapped = mmap(nullptr, fileStatus.st_size, PROT_READ, flags, file, 0);
+				if (mapped != MAP_FAILED)
+				{
+					madvise(mapped, fileStatus.st_size, MADV_SEQUENTIAL);		// file is read once from beginning to end
+					data = static_cast<const unsigned char*>(mapped);
+					size = static_cast<size_t>(fileStatus.st_size);
+				}
+			}
+			close(file);														// mapping stays valid after closing
+#endif
+		}
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if (data != nullptr) UnmapViewOfFile(data);
+			if (mapping != nullptr) CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+			if (data != nullptr) munmap(const_cast<unsigned char*>(data), size);
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+
+		inline const unsigned char* getData() { return data; }
+		inline size_t getSize() { return size; }
+	};
+
+
+
+
+	// File writer keeps checksum of everything written after the header
+
+	class FileWriter
+	{
+		FILE* file;
+		Checksum checksum;
+		bool failed = false;
+
+	public:
+		FileWriter(FILE* file) : file(file) {	}
+
+		void write(const void* data, size_t bytes)
+		{
+			if (bytes == 0) return;
+			if (std::fwrite(data, 1, bytes, file) != bytes) failed = true;
+			if (bytes % 8 == 0) checksum.add(data, bytes);
+			else
+			{
+				size_t wholeWords = bytes & ~static_cast<size_t>(7);			// only byte sections are not whole words, they're the last ones before padding
+				checksum.add(data, wholeWords);
+				unsigned char lastWord[8] = {};
+				std::memcpy(lastWord, static_cast<const unsigned char*>(data) + wholeWords, bytes - wholeWords);
+				checksum.add(lastWord, 8);
+
+				const unsigned char zeros[8] = {};
+				if (std::fwrite(zeros, 1, 8 - (bytes - wholeWords), file) != 8 - (bytes - wholeWords)) failed = true;
+			}
+		}
+
+		inline bool hasFailed() { return failed; }
+		inline uint64_t getChecksum() { return checksum.getValue(); }
+	};
+
+
+
+
+	// PolylineFile
+
+	bool PolylineFile::save(PolyLine& polyLine, const string& path)
+	{
+		if (!hostIsLittleEndian()) return false;				// values are written as they're in memory
+
+		NodeStore& nodes = polyLine.getNodes();
+		size_t nodesCount = nodes.size();
+		size_t arcsCount = nodes.arcsBefore(nodesCount);
+
+		FILE* file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr) return false;
+
+		Header header = {};
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = version;
+		header.headerSize = sizeof(Header);
+		header.nodesCount = nodesCount;
+		header.arcsCount = arcsCount;
+		header.sectionsSize = sectionsSize(nodesCount, arcsCount);
+		bool written = (std::fwrite(&header, sizeof(Header), 1, file) == 1);		// checksum is written again at the end
+
+		FileWriter writer(file);
+		writer.write(nodes.kinds.data(), nodesCount);
+		writer.write(nodes.endPoints.data(), nodesCount * sizeof(Point<double>));
+
+		vector<double> values(2 * arcsCount);				// arc fields are written one after another, every one as its own array
+		for (size_t i = 0; i < arcsCount; i++)
+		{
+			auto center = nodes.arcs[i].getCenterPoint();
+			values[2 * i] = center.x;
+			values[2 * i + 1] = center.y;
+		}
+		writer.write(values.data(), 2 * arcsCount * sizeof(double));
+
+		for (size_t i = 0; i < arcsCount; i++)
+			values[i] = nodes.arcs[i].getRadius();
+		writer.write(values.data(), arcsCount * sizeof(double));
+
+		for (size_t i = 0; i < arcsCount; i++)
+			values[i] = nodes.arcs[i].getBeginPointAngle().value;
+		writer.write(values.data(), arcsCount * sizeof(double));
+
+		for (size_t i = 0; i < arcsCount; i++)
+			values[i] = nodes.arcs[i].getEndPointAngle().value;
+		writer.write(values.data(), arcsCount * sizeof(double));
+
+		writer.write(nodes.peakPoints.data(), arcsCount * sizeof(Point<double>));
+
+		vector<unsigned char> directions(arcsCount);
+		for (size_t i = 0; i < arcsCount; i++)
+			directions[i] = nodes.arcs[i].isCounterClockWise() ? 1 : 0;
+		writer.write(directions.data(), arcsCount);
+
+		header.checksum = writer.getChecksum();
+		written = written && (!writer.hasFailed());
+		written = written && (std::fseek(file, 0, SEEK_SET) == 0) && (std::fwrite(&header, sizeof(Header), 1, file) == 1);
+		written = (std::fclose(file) == 0) && written;
+		return written;
+	}
+
+
+	unique_ptr<PolyLine> PolylineFile::load(const string& path, bool verifyChecksum)
+	{
+		if (!hostIsLittleEndian()) return nullptr;
+
+		MappedFile file(path);
+		if (file.getSize() < sizeof(Header)) return nullptr;
+
+		Header header;
+		std::memcpy(&header, file.getData(), sizeof(Header));
+		if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) return nullptr;
+		if ((header.version != version) || (header.headerSize < sizeof(Header))) return nullptr;
+		if ((header.nodesCount == 0) || (header.arcsCount >= header.nodesCount)) return nullptr;	// there's always the first node, which isn't an arc
+		if (header.nodesCount > file.getSize()) return nullptr;										// every node takes more than a byte, so counts can't overflow below
+		if (header.sectionsSize != sectionsSize(header.nodesCount, header.arcsCount)) return nullptr;
+		if (header.headerSize + header.sectionsSize > file.getSize()) return nullptr;
+
+		const unsigned char* sections = file.getData() + header.headerSize;
+		if (verifyChecksum)
+		{
+			Checksum checksum;
+			checksum.add(sections, header.sectionsSize);
+			if (checksum.getValue() != header.checksum) return nullptr;
+		}
+
+		size_t nodesCount = header.nodesCount;
+		size_t arcsCount = header.arcsCount;
+		const unsigned char* kinds = sections;
+		const unsigned char* endPoints = kinds + padded(nodesCount);
+		const unsigned char* arcCenters = endPoints + 2 * sizeof(double) * nodesCount;
+		const unsigned char* arcRadiuses = arcCenters + 2 * sizeof(double) * arcsCount;
+		const unsigned char* arcBeginAngles = arcRadiuses + sizeof(double) * arcsCount;
+		const unsigned char* arcEndAngles = arcBeginAngles + sizeof(double) * arcsCount;
+		const unsigned char* arcPeakPoints = arcEndAngles + sizeof(double) * arcsCount;
+		const unsigned char* arcDirections = arcPeakPoints + 2 * sizeof(double) * arcsCount;
+
+		NodeStore nodes;												// arrays are copied straight from the mapped file, sections are aligned to 8 bytes
+		auto kindsArray = reinterpret_cast<const NodeKind*>(kinds);
+		auto endPointsArray = reinterpret_cast<const Point<double>*>(endPoints);
+		auto peakPointsArray = reinterpret_cast<const Point<double>*>(arcPeakPoints);
+		nodes.kinds.assign(kindsArray, kindsArray + nodesCount);
+		nodes.endPoints.assign(endPointsArray, endPointsArray + nodesCount);
+		nodes.peakPoints.assign(peakPointsArray, peakPointsArray + arcsCount);
+
+		nodes.arcIndexes.resize(nodesCount);
+		unsigned int arcsBefore = 0;
+		for (size_t i = 0; i < nodesCount; i++)				// checks kinds and end points and sets arc indexes in one pass
+		{
+			auto kind = nodes.kinds[i];
+			if ((kind != NodeKind::First) && (kind != NodeKind::Line) && (kind != NodeKind::Arc)) return nullptr;
+			if ((kind == NodeKind::First) != (i == 0)) return nullptr;
+			if (!(std::isfinite(nodes.endPoints[i].x) && std::isfinite(nodes.endPoints[i].y))) return nullptr;	// boxes and grid can't hold such points
+
+			nodes.arcIndexes[i] = arcsBefore;
+			if (kind == NodeKind::Arc) arcsBefore++;
+		}
+		if (arcsBefore != arcsCount) return nullptr;
+
+		nodes.arcs.reserve(arcsCount);
+		for (size_t i = 0; i < arcsCount; i++)
+		{
+			double center[2], radius, beginAngle, endAngle;
+			std::memcpy(center, arcCenters + 2 * sizeof(double) * i, 2 * sizeof(double));
+			std::memcpy(&radius, arcRadiuses + sizeof(double) * i, sizeof(double));
+			std::memcpy(&beginAngle, arcBeginAngles + sizeof(double) * i, sizeof(double));
+			std::memcpy(&endAngle, arcEndAngles + sizeof(double) * i, sizeof(double));
+			if (!((beginAngle >= 0) && (beginAngle <= 2 * pi) && (endAngle >= 0) && (endAngle <= 2 * pi))) return nullptr;	// also false for NaN
+			if (!((radius > 0) && std::isfinite(radius) && std::isfinite(center[0]) && std::isfinite(center[1]))) return nullptr;	// tessellation can't divide such arcs
+			nodes.arcs.push_back(Arc(Radians(beginAngle), Radians(endAngle), Point<double>(center[0], center[1]), radius, arcDirections[i] != 0));
+		}
+
+		nodes.nodesCount = nodesCount;
+		return make_unique<PolyLine>(std::move(nodes));
+	}
+}
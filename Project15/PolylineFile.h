@@ -0,0 +1,45 @@
+#pragma once
+#include "Polyline.h"
+#include <cstdint>
+#include <string>
+
+
+
+namespace obj
+{
+	using std::string;
+
+
+	// PolylineFile keeps polyline in a binary file. Values are little-endian and nodes are stored as flat arrays, in the same form
+	// as NodeStore keeps them, so the loader maps the file into memory and copies arrays without parsing anything.
+	// File is a header followed by sections, every section begins at a multiple of 8 bytes (zero padding):
+	//		kinds				uint8[nodesCount]			NodeKind of every node
+	//		endPoints			double[2 * nodesCount]		x, y of every node
+	//		arcCenters			double[2 * arcsCount]		x, y
+	//		arcRadiuses			double[arcsCount]
+	//		arcBeginAngles		double[arcsCount]			radians, from 0 to 2 * pi
+	//		arcEndAngles		double[arcsCount]
+	//		arcPeakPoints		double[2 * arcsCount]		x, y
+	//		arcDirections		uint8[arcsCount]			1 when arc is counterclockwise
+	// Checksum is computed over all sections as 64 bit words
+	class PolylineFile
+	{
+	public:
+		static const char magic[8];
+		static const uint32_t version = 1;
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t headerSize;								// bytes before the first section
+			uint64_t nodesCount;
+			uint64_t arcsCount;
+			uint64_t sectionsSize;								// bytes of all sections with padding
+			uint64_t checksum;
+		};
+
+		static bool save(PolyLine& polyLine, const string& path);								// returns false when file can't be written
+		static unique_ptr<PolyLine> load(const string& path, bool verifyChecksum = true);		// returns nullptr when file can't be read, is damaged or has other version
+	};
+}
@@ -1,4 +1,5 @@
 #include "Primitives.h"
+#include "Tessellation.h"
 
 
 namespace primitives
@@ -172,37 +173,19 @@ namespace primitives
 	}
 
 
-	// Arc interface
+	// Arc
 
-	Radians Arc::divide(unsigned int sections)
-	{
-		Radians rad;
-		return (rad.value /= sections);
-	}
-
-	Vector<double> Arc::setBeginVector()								// returns vector rotated of beginPointAngle
-	{
-		auto vector = Vector<double>(radius, 0);						// puts radius vertical, right on the x axis
-		vector.rotate(beginPointAngle);
-		return vector;
-	}
-
-	void Arc::moveVertex(unique_ptr<VertexChain<double>>& vertexChain)	// circle is calculated as it was found in the middlepoint of coordinates. This method moves th circle in place where it should find
-	{
-		auto vector = Vector<double>(center);
-		for (Point<double>& vertex : vertexChain->getVertexes())
-			vertex.move(vector);
-	}
-
-	Arc::Arc(Radians beginPointAngle, Radians endPointAngle, Point<double> center, double radius)
+	Arc::Arc(Radians beginPointAngle, Radians endPointAngle, Point<double> center, double radius, bool counterClockWise)
 		: radius(radius),
 		center(center),
 		beginPointAngle(beginPointAngle),
-		endPointAngle(endPointAngle)
+		endPointAngle(endPointAngle),
+		counterClockWise(counterClockWise)
 	{	}
 
-	Arc::Arc(Point<double> beginPoint, Point<double> endPoint, Point<double> center)
-		: center(center)
+	Arc::Arc(Point<double> beginPoint, Point<double> endPoint, Point<double> center, bool counterClockWise)
+		: center(center),
+		counterClockWise(counterClockWise)
 	{
 		auto beginPointAsVector = Vector<double>(center, beginPoint);
 		beginPointAngle = beginPointAsVector.getAngle();
@@ -214,120 +197,40 @@ namespace primitives
 
 
 	Point<double> Arc::getCenterPoint() { return center; }
+	double Arc::getRadius() { return radius; }
 	Radians Arc::getBeginPointAngle() { return beginPointAngle; }
 	Radians Arc::getEndPointAngle() { return endPointAngle; }
+	bool Arc::isCounterClockWise() { return counterClockWise; }
 
-
-
-
-
-
-	// ClockWiseArc
-
-	ClockWiseArc::ClockWiseArc(Point<double> beginPoint, Point<double> endPoint, Point<double> center)
-		: Arc(beginPoint, endPoint, center)
-	{	}
-
-	bool ClockWiseArc::isCounterClockWise() { return false; }
-	void ClockWiseArc::generateVertexes(VertexChain<double>& vertexChain, unsigned int sections) 
+	double Arc::getSweep()
 	{
-		auto centerVector = Vector<double>(center);
 		Radians translatedEndPointRotation;
 		translatedEndPointRotation = endPointAngle - beginPointAngle;	// both angles are now rotated: beginPointAngle = 0, endPointAngle got smaller;
 
-		auto rotatingVector = setBeginVector();							// this vector point at beginPoint
-		Radians rotation = 0;
-		auto circleSection = divide(sections);
-
-		rotatingVector.rotate(-1 * circleSection);
-		rotation -= circleSection;
-
-		while (rotation > translatedEndPointRotation)
-		{
-			Point<double> circlePoint = Point<double>(rotatingVector);
-			circlePoint.move(centerVector);
-			vertexChain.add(circlePoint);
-			rotatingVector.rotate(-1 * circleSection);
-			rotation -= circleSection;
-		}
-
-		auto lastPointVector = Vector<double>(radius, 0);
-		lastPointVector.rotate(endPointAngle);
-		auto lastPoint = Point<double>(lastPointVector);
-		lastPoint.move(centerVector);
-		vertexChain.add(lastPoint);
+		if (counterClockWise) return translatedEndPointRotation.value;
+		return -(2 * pi - translatedEndPointRotation.value);
 	}
 
-	Point<double> ClockWiseArc::getPeakPoint()
+	Point<double> Arc::getPeakPoint()
 	{
 		Radians middleRotation;
-		if (endPointAngle > beginPointAngle)
-			middleRotation.value = (2 * pi - endPointAngle.value + beginPointAngle.value) / 2;
-		else middleRotation.value = (beginPointAngle.value - endPointAngle.value) / 2;
-		auto radiusVector = Vector<double>(radius, 0);
-		radiusVector.rotate(beginPointAngle);
-		radiusVector.rotate(-1 * middleRotation);
-
-		auto peakPoint = Point<double>(radiusVector);
-		auto centerVector = Vector<double>(center);
-		peakPoint.move(centerVector);
 
-		return peakPoint;
-	}
-
-
-
-
-
-	//CounterClockWiseArc
-
-	CounterClockWiseArc::CounterClockWiseArc(Point<double> beginPoint, Point<double> endPoint, Point<double> center)
-		: Arc(beginPoint, endPoint, center)
-	{	}
-
-	bool CounterClockWiseArc::isCounterClockWise() { return true; }
-
-	void CounterClockWiseArc::generateVertexes(VertexChain<double>& vertexChain, unsigned int sections)
-	{
-		auto centerVector = Vector<double>(center);
-		Radians transpiredEndPointRotation;
-		transpiredEndPointRotation = endPointAngle - beginPointAngle;	// both angles are now rotated: beginPointAngle = 0, endPointAngle got smaller;
-
-		auto rotatingVector = setBeginVector();		// this vector point at beginPoint
-		Radians rotation = 0;						// rotatingVector.getAngle();
-		auto circleSection = divide(sections);
-
-		rotatingVector.rotate(circleSection);
-		rotation += circleSection;
-		
-		while (rotation < transpiredEndPointRotation)
+		if (counterClockWise)
 		{
-			Point<double> circlePoint = Point<double>(rotatingVector);
-			circlePoint.move(centerVector);
-			vertexChain.add(circlePoint);
-			rotatingVector.rotate(circleSection);
-			rotation += circleSection;
+			if (beginPointAngle > endPointAngle)
+				middleRotation.value = (endPointAngle.value + 2 * pi - beginPointAngle.value) / 2;
+			else middleRotation.value = (endPointAngle.value - beginPointAngle.value) / 2;
+		}
+		else
+		{
+			if (endPointAngle > beginPointAngle)
+				middleRotation.value = (2 * pi - endPointAngle.value + beginPointAngle.value) / 2;
+			else middleRotation.value = (beginPointAngle.value - endPointAngle.value) / 2;
+			middleRotation = -1 * middleRotation;
 		}
-
-		auto lastPointVector = Vector<double>(radius, 0);
-		lastPointVector.rotate(endPointAngle);
-		auto lastPoint = Point<double>(lastPointVector);
-		lastPoint.move(centerVector);
-		vertexChain.add(lastPoint);
-	}
-
-
-	Point<double> CounterClockWiseArc::getPeakPoint()
-	{
-		Radians middleRotation;
-
-		if (beginPointAngle > endPointAngle)
-			middleRotation.value = (endPointAngle.value + 2 * pi - beginPointAngle.value) / 2;
-		else middleRotation.value = (endPointAngle.value - beginPointAngle.value) / 2;
 
 		auto radiusVector = Vector<double>(radius, 0);
-		radiusVector.rotate(beginPointAngle);
-		radiusVector.rotate(middleRotation);
+		radiusVector.rotate(beginPointAngle + middleRotation);
 
 		auto peakPoint = Point<double>(radiusVector);
 		auto centerVector = Vector<double>(center);
@@ -336,190 +239,93 @@ namespace primitives
 		return peakPoint;
 	}
 
-
-
-
-	// LineInterface
-
-	unique_ptr<LineInterface> LineInterface::createLine(Section<double>& section)
-	{
-		
-		unique_ptr<LineInterface> line;
-		if (section.isVertical())
-			return make_unique<VerticalLine>(section);
-
-		if (section.isHorisontal())
-			return make_unique<HorisontalLine>(section);
-
-		return make_unique<Line>(section);
-	}
-
-
-
-
-
-
-	// setting lines perpendicular
-
-	unique_ptr<LineInterface> VerticalLine::setPerpendicular(Point<double> point)
+	BoundingBox<double> Arc::getBoundingBox()
 	{
-		unique_ptr<LineInterface> perpendicularLine = make_unique<HorisontalLine>();
-		perpendicularLine->moveThrough(point);
-		return perpendicularLine;
-	}
+		double beginAngle = beginPointAngle.value;
+		double endAngle = endPointAngle.value;
 
-	unique_ptr<LineInterface> HorisontalLine::setPerpendicular(Point<double> point)
-	{
-		unique_ptr<LineInterface> perpendicularLine = make_unique<VerticalLine>();
-		perpendicularLine->moveThrough(point);
-		return perpendicularLine;
+		auto box = BoundingBox<double>();
+		box.add(Point<double>(center.x + radius * cos(beginAngle), center.y + radius * sin(beginAngle)));
+		box.add(Point<double>(center.x + radius * cos(endAngle), center.y + radius * sin(endAngle)));
+		addExtremes(box);
+		return box;
 	}
 
-	unique_ptr<LineInterface> Line::setPerpendicular(Point<double> point)
+	void Arc::addExtremes(BoundingBox<double>& box)
 	{
-		unique_ptr<LineInterface> perpendicularLine = make_unique<Line>((-1 / a), b);
-		perpendicularLine->moveThrough(point);
-		return perpendicularLine;
-	}
-
-
+		double fromAngle = counterClockWise ? beginPointAngle.value : endPointAngle.value;	// arc goes counterclockwise from fromAngle to toAngle
+		double toAngle = counterClockWise ? endPointAngle.value : beginPointAngle.value;
+		if ((fromAngle <= toAngle) && (floor(fromAngle / (pi / 2)) == floor(toAngle / (pi / 2)))) return;	// arc inside one quarter of circle (most of them) has no extremes
 
-	// VerticalLine
-
-	VerticalLine::VerticalLine(Section<double>& section)
-	{
-		x = section.begin.x;
+		const Point<double> extremes[5] =											// points of circle that are the furthest in x and y directions, at 0, 90, 180, 270 and 360 degrees
+		{
+			Point<double>(center.x + radius, center.y),
+			Point<double>(center.x, center.y + radius),
+			Point<double>(center.x - radius, center.y),
+			Point<double>(center.x, center.y - radius),
+			Point<double>(center.x + radius, center.y)
+		};
+		for (int quarter = 0; quarter < 5; quarter++)
+			if (containsAngle(quarter * pi / 2)) box.add(extremes[quarter]);
 	}
-	double VerticalLine::getX() { return x; }
-	bool VerticalLine::isVertical() { return true; }
-	bool VerticalLine::isHorisontal() { return false; }
-	bool VerticalLine::isParallel(LineInterface& line) { return isVertical(); }
 
-	void VerticalLine::moveThrough(Point<double>& point)
+	bool Arc::containsAngle(double angle)
 	{
-		x = point.x;
+		double fromAngle = counterClockWise ? beginPointAngle.value : endPointAngle.value;	// arc goes counterclockwise from fromAngle to toAngle
+		double toAngle = counterClockWise ? endPointAngle.value : beginPointAngle.value;
+		return (fromAngle <= toAngle) ? ((fromAngle <= angle) && (angle <= toAngle)) : ((angle >= fromAngle) || (angle <= toAngle));
 	}
 
-	bool VerticalLine::getIntersectionPoint(LineInterface& anotherLine, Point<double>& point)
+	bool Arc::projectPoint(Point<double> point, Point<double>& projection)
 	{
-		if (anotherLine.isVertical())
-			return false;
+		double distanceX = point.x - center.x;
+		double distanceY = point.y - center.y;
+		double distance = sqrt(distanceX * distanceX + distanceY * distanceY);
+		if (distance == 0) return false;								// all points of circle are equally near to center, arc end is as good as any
 
-		if (anotherLine.isHorisontal())
-		{
-			HorisontalLine& line = dynamic_cast<HorisontalLine&>(anotherLine);
-			point.x = x;
-			point.y = line.getY();
-			return true;
-		}
+		double angle = atan2(distanceY, distanceX);
+		if (angle < 0) angle += 2 * pi;
+		if (!containsAngle(angle) && !((angle == 0) && containsAngle(2 * pi))) return false;	// angles of arc can end at 2 pi instead of 0
 
-		auto line = dynamic_cast<Line&>(anotherLine);
-		point.x = x;
-		point.y = line.getY(x);
+		projection = Point<double>(center.x + distanceX * radius / distance, center.y + distanceY * radius / distance);
 		return true;
 	}
 
-
-	// HorisontalLine
-
-	HorisontalLine::HorisontalLine(Section<double>& section) : y(section.begin.y) {}
-	double HorisontalLine::getY() { return y; }
-	bool HorisontalLine::isVertical() { return false; }
-	bool HorisontalLine::isHorisontal() { return true; }
-	bool HorisontalLine::isParallel(LineInterface& line) { return isHorisontal(); }
-
-	void HorisontalLine::moveThrough(Point<double>& point) 
+	unsigned int Arc::vertexCount(ArcAccuracy accuracy)
 	{
-		y = point.y;
+		auto tessellator = ArcTessellator(center, radius, beginPointAngle, getSweep());
+		return tessellator.vertexCount(accuracy);
 	}
 
-	bool HorisontalLine::getIntersectionPoint(LineInterface& anotherLine, Point<double>& point) 
+	void Arc::generateVertexes(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy)
 	{
-		if (anotherLine.isHorisontal())
-			return false;
-
-		if (anotherLine.isVertical())
-		{
-			auto line = dynamic_cast<VerticalLine&>(anotherLine);
-			point.y = y;
-			point.x = line.getX();
-			return true;
-		}
-
-		auto line = dynamic_cast<Line&>(anotherLine);
-		point.y = y;
-		point.x = line.getX(y);
-		return true;
+		auto tessellator = ArcTessellator(center, radius, beginPointAngle, getSweep());
+		tessellator.generateVertexes(vertexBuffer, accuracy);
 	}
 
-
-
-
-	// Line
-
-	Line::Line(double a, double b) : a(a), b(b) {	}
-	double Line::getY(double x) { return (a * x) + b; }
-	double Line::getX(double y) { return (y - b) / a; }
-	double Line::getA() { return a; }
-	double Line::getB() { return b; }
-	bool Line::isVertical() { return false; }
-	bool Line::isHorisontal() { return false; }
-	bool Line::isParallel(LineInterface& line) 
+	void Arc::generateVertexes(double* xs, double* ys, ArcAccuracy accuracy)
 	{
-		if ((line.isHorisontal()) || (line.isVertical())) return false;
-
-		Line& skewLine = dynamic_cast<Line&>(line);
-		return (skewLine.a == a);
+		auto tessellator = ArcTessellator(center, radius, beginPointAngle, getSweep());
+		tessellator.generateVertexes(xs, ys, accuracy);
 	}
 
-	Line::Line(Section<double>& section)
-	{
-		setOnSection(section);
-	}
 
-	Line::Line(Point<double>& beginPoint, Point<double>& endPoint)
-	{
-		auto section = Section<double>(beginPoint, endPoint);
-		setOnSection(section);
-	}
 
-	void Line::setOnSection(Section<double>& section)
-	{
-		a = (section.end.y - section.begin.y) / (section.end.x - section.begin.x);
-		b = section.begin.y - (a*section.begin.x);
-	}
 
 
-	void Line::moveThrough(Point<double>& point)
-	{
-		b = point.y - (a*point.x);
-	}
+	// ClockWiseArc
 
-	bool Line::getIntersectionPoint(LineInterface& anotherLine, Point<double>& point)
-	{
-		if (anotherLine.isHorisontal())
-		{
-			auto horisontalLine = dynamic_cast<HorisontalLine&>(anotherLine);
-			point.y = horisontalLine.getY();
-			point.x = getX(point.y);
-			return true;
-		}
+	ClockWiseArc::ClockWiseArc(Point<double> beginPoint, Point<double> endPoint, Point<double> center)
+		: Arc(beginPoint, endPoint, center, false)
+	{	}
 
-		if (anotherLine.isVertical())
-		{
-			auto verticalLine = dynamic_cast<VerticalLine&>(anotherLine);
-			point.x = verticalLine.getX();
-			point.y = getY(point.x);
-			return true;
-		}
 
-		if (this->isParallel(anotherLine)) return false;
 
 
-		auto line = dynamic_cast<Line&>(anotherLine);
 
-		point.x = (line.b - b) / (a - line.a);
-		point.y = (point.x * line.a) + line.b;
-		return true;
-	}
+	//CounterClockWiseArc
+
+	CounterClockWiseArc::CounterClockWiseArc(Point<double> beginPoint, Point<double> endPoint, Point<double> center)
+		: Arc(beginPoint, endPoint, center, true)
+	{	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <limits>
 
 namespace primitives
 {
@@ -10,9 +11,7 @@ namespace primitives
 	using std::make_unique;
 
 
-	class VerticalLine;
-	class HorisontalLine;
-	class Line;
+	struct ArcAccuracy;
 
 
 	const double pi = 3.14159265358979323846;
@@ -159,113 +158,183 @@ namespace primitives
 
 		bool isVertical() { return(begin.x == end.x); }
 		bool isHorisontal() { return(begin.y == end.y); }
+		Point<T> getClosestPoint(Point<T>& point)									// returns the point of section that is the nearest to given point
+		{
+			double directionX = end.x - begin.x;
+			double directionY = end.y - begin.y;
+			double lengthSquared = directionX * directionX + directionY * directionY;
+			if (lengthSquared == 0) return begin;
+
+			double position = ((point.x - begin.x) * directionX + (point.y - begin.y) * directionY) / lengthSquared;	// 0 in begin, 1 in end
+			if (position <= 0) return begin;
+			if (position >= 1) return end;
+			return Point<T>(static_cast<T>(begin.x + position * directionX), static_cast<T>(begin.y + position * directionY));
+		}
 
 	};
 
 
-	// Line has to be polymorphic because vertical line is not a function so at least it has to be treated separately
-	// horisontal line was separated as well, to avoid dividing by 0 (a parameter = 0)
-	class LineInterface
-	{
-	public:
-		static unique_ptr<LineInterface> createLine(Section<double>& section);							// method that creates lines							
-		virtual void moveThrough(Point<double>&) = 0;													// move the line through specific point
-		virtual bool isVertical() = 0;
-		virtual bool isHorisontal() = 0;
-		virtual bool isParallel(LineInterface& line) = 0;
-		virtual ~LineInterface() = default;
-		virtual bool getIntersectionPoint(LineInterface& anotherLine, Point<double>& point) = 0;		// finds intersection point and sets it to Point<T> point, returns true if there is intersection
-		virtual unique_ptr<LineInterface> setPerpendicular(Point<double> point) = 0;					// returns the line that is perpendicular to the given line and movesit through point
-	};
-
-
-
-	class VerticalLine
-		: public LineInterface
-	{
-		double x;
-
-	public:
-		VerticalLine() = default;
-		VerticalLine(Section<double>& section);
-		inline double getX();
-		bool isVertical() override;
-		bool isHorisontal() override;
-		bool isParallel(LineInterface& line) override;
-		void moveThrough(Point<double>& point) override;
-		bool getIntersectionPoint(LineInterface& anotherLine, Point<double>& point) override;
-		unique_ptr<LineInterface> setPerpendicular(Point<double> point) override;
-	};
-
-
-
-
-
-	class HorisontalLine
-		: public LineInterface
+	// BoundingBox is an axis aligned rectangle around points. Empty box has minPoint above maxPoint (infinities),
+	// so adding the first point sets both corners and empty box never intersects anything
+	template<class T>
+	struct BoundingBox
 	{
+		Point<T> minPoint;
+		Point<T> maxPoint;
 
-		double y;
+		BoundingBox()
+			:	minPoint(std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity()),
+				maxPoint(-std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity())
+		{	}
+		BoundingBox(Point<T> minPoint, Point<T> maxPoint) : minPoint(minPoint), maxPoint(maxPoint) {}
 
-	public:
-		HorisontalLine() = default;
-		HorisontalLine(Section<double>& section);
-		inline double getY();
-
-		bool isVertical() override;
-		bool isHorisontal() override;
-		bool isParallel(LineInterface& line) override;
-		void moveThrough(Point<double>& point) override;
-		bool getIntersectionPoint(LineInterface& anotherLine, Point<double>& point) override;
-		unique_ptr<LineInterface> setPerpendicular(Point<double> point) override;
+		inline bool isEmpty() { return (minPoint.x > maxPoint.x) || (minPoint.y > maxPoint.y); }
+		inline void add(Point<T> point)
+		{
+			if (point.x < minPoint.x) minPoint.x = point.x;
+			if (point.y < minPoint.y) minPoint.y = point.y;
+			if (point.x > maxPoint.x) maxPoint.x = point.x;
+			if (point.y > maxPoint.y) maxPoint.y = point.y;
+		}
+		inline void add(const BoundingBox<T>& box)
+		{
+			if (box.minPoint.x < minPoint.x) minPoint.x = box.minPoint.x;
+			if (box.minPoint.y < minPoint.y) minPoint.y = box.minPoint.y;
+			if (box.maxPoint.x > maxPoint.x) maxPoint.x = box.maxPoint.x;
+			if (box.maxPoint.y > maxPoint.y) maxPoint.y = box.maxPoint.y;
+		}
+		inline bool intersects(const BoundingBox<T>& box)										// boxes that only touch intersect too
+		{
+			return (minPoint.x <= box.maxPoint.x) && (box.minPoint.x <= maxPoint.x) && (minPoint.y <= box.maxPoint.y) && (box.minPoint.y <= maxPoint.y);
+		}
+		inline bool contains(Point<T> point)
+		{
+			return (minPoint.x <= point.x) && (point.x <= maxPoint.x) && (minPoint.y <= point.y) && (point.y <= maxPoint.y);
+		}
+		inline T distanceSquared(Point<T> point)												// squared distance from point to box, 0 inside, infinity for empty box
+		{
+			T distanceX = (point.x < minPoint.x) ? minPoint.x - point.x : ((point.x > maxPoint.x) ? point.x - maxPoint.x : 0);
+			T distanceY = (point.y < minPoint.y) ? minPoint.y - point.y : ((point.y > maxPoint.y) ? point.y - maxPoint.y : 0);
+			return distanceX * distanceX + distanceY * distanceY;
+		}
+		inline void inflate(T distance)															// moves every side outside by distance
+		{
+			minPoint.x -= distance;
+			minPoint.y -= distance;
+			maxPoint.x += distance;
+			maxPoint.y += distance;
+		}
 	};
 
 
 
-	class Line
-		: public LineInterface
+	// Line is kept in implicit form a * x + b * y = c, so vertical and horisontal lines are not special cases.
+	// It's a plain value, lines made during arc construction live on the stack
+	struct Line
 	{
+		double a, b, c;
 
-
-		double a, b;			// y = a x + b
-	public:
 		Line() = default;
-		Line(double a, double b);
-		inline double getY(double x);
-		inline double getX(double y);
-		inline double getA();
-		inline double getB();
-	
-		bool isVertical() override;
-		bool isHorisontal() override;
-		bool isParallel(LineInterface& line) override;
-
-		Line(Section<double>& section);
-		Line(Point<double>& beginPoint, Point<double>& endPoint);
-		inline void setOnSection(Section<double>& section);
-		void moveThrough(Point<double>& point) override;
-		bool getIntersectionPoint(LineInterface& anotherLine, Point<double>& point) override;
-		unique_ptr<LineInterface> setPerpendicular(Point<double> point) override;
+		Line(double a, double b, double c) : a(a), b(b), c(c) {}
+		Line(Section<double>& section)																// line going through both ends of section
+			:	a(section.end.y - section.begin.y),
+				b(section.begin.x - section.end.x),
+				c(a * section.begin.x + b * section.begin.y)
+		{	}
+
+		inline bool isParallel(Line& line) { return (a * line.b - b * line.a == 0); }
+		inline void moveThrough(Point<double>& point) { c = a * point.x + b * point.y; }			// move the line through specific point
+		inline Line setPerpendicular(Point<double>& point)											// returns the line that is perpendicular to this one and goes through point
+		{
+			return Line(b, -a, b * point.x - a * point.y);
+		}
+		inline bool getIntersectionPoint(Line& anotherLine, Point<double>& point)					// finds intersection point and sets it to point, returns false if lines are parallel
+		{
+			double determinant = a * anotherLine.b - b * anotherLine.a;
+			if (determinant == 0) return false;
+
+			point.x = (c * anotherLine.b - b * anotherLine.c) / determinant;
+			point.y = (a * anotherLine.c - c * anotherLine.a) / determinant;
+			return true;
+		}
 	};
 
 
 
 
+	// VertexBuffer keeps vertexes in two contiguous arrays (x and y coordinates), so whole buffer can be transformed in place (see AffineTransform).
+	// It's meant to be reused between frames: clear() keeps allocated memory, so steady drawing doesn't allocate
 	template<class T>
-	class VertexChain
+	class VertexBuffer
 	{
-		vector<Point<T>> vertexes;
+		vector<T> xs;
+		vector<T> ys;
 	public:
-		VertexChain() : vertexes() {}
-		inline vector<Point<T>>& getVertexes() { return vertexes; }
-		void add(Point<T> point) { vertexes.push_back(point); }
-		void operator+=(Point<T> point)	{ vertexes.push_back(point); }
+		VertexBuffer() : xs(), ys() {}
+		inline size_t size() { return xs.size(); }
+		inline bool empty() { return xs.empty(); }
+		inline T* getX() { return xs.data(); }
+		inline T* getY() { return ys.data(); }
+		inline Point<T> operator[](size_t index) { return Point<T>(xs[index], ys[index]); }
+		void reserve(size_t count)																// size hint, so adding vertexes doesn't reallocate
+		{
+			if (count <= xs.capacity()) return;
+			if (count < 2 * xs.capacity()) count = 2 * xs.capacity();							// grows at least twice, so hints that rise by few vertexes every frame don't reallocate every time
+			xs.reserve(count);
+			ys.reserve(count);
+		}
+		void clear()																			// removes vertexes, memory stays allocated
+		{
+			xs.clear();
+			ys.clear();
+		}
+		void truncate(size_t count)																// removes vertexes after the first count ones
+		{
+			xs.resize(count);
+			ys.resize(count);
+		}
+		void grow(size_t count)																	// adds count vertexes that are set later through getX and getY (ex. by many threads)
+		{
+			xs.resize(xs.size() + count);
+			ys.resize(ys.size() + count);
+		}
+		void add(Point<T> point)
+		{
+			xs.push_back(point.x);
+			ys.push_back(point.y);
+		}
+		void add(VertexBuffer<T>& vertexBuffer)													// appends all vertexes of another buffer
+		{
+			add(vertexBuffer, vertexBuffer.size());
+		}
+		void add(VertexBuffer<T>& vertexBuffer, size_t count)									// appends the first count vertexes of another buffer
+		{
+			add(vertexBuffer, 0, count);
+		}
+		void add(VertexBuffer<T>& vertexBuffer, size_t first, size_t count)					// appends count vertexes of another buffer, beginning from first
+		{
+			xs.insert(xs.end(), vertexBuffer.xs.begin() + first, vertexBuffer.xs.begin() + first + count);
+			ys.insert(ys.end(), vertexBuffer.ys.begin() + first, vertexBuffer.ys.begin() + first + count);
+		}
+		void operator+=(Point<T> point) { add(point); }
+		void copyInterleaved(vector<float>& vertexes)											// writes vertexes as (x, y) pairs of floats, the way gl vertex arrays take them
+		{
+			size_t count = xs.size();
+			vertexes.resize(2 * count);
+			float* vertex = vertexes.data();
+			for (size_t i = 0; i < count; i++)
+			{
+				vertex[2 * i] = static_cast<float>(xs[i]);
+				vertex[2 * i + 1] = static_cast<float>(ys[i]);
+			}
+		}
 	};
 
 
 
 
-	// Arc is polymorphic, there are two types of arcs clockwise and countrclockwise
+	// Arc is a plain value, so it can be stored in contiguous arrays. There are two types of arcs clockwise and countrclockwise,
+	// direction is kept in a flag. ClockWiseArc and CounterClockWiseArc only construct arcs of given direction
 	class Arc
 	{
 	protected:
@@ -274,21 +343,27 @@ namespace primitives
 		double radius;
 		Radians beginPointAngle;
 		Radians endPointAngle;
+		bool counterClockWise;
 
-		inline Radians divide(unsigned int sections);					// divides circles on sections
-		inline Vector<double> setBeginVector();							// returns vector rotated of beginPointAngle
-		void moveVertex(unique_ptr<VertexChain<double>>& vertexChain);	// circle is calculated as it was found in the middlepoint of coordinates. This method moves th circle in place where it should find
 	public:
-		Arc(Radians beginPointAngle, Radians endPointAngle, Point<double> center, double radius);
-		Arc(Point<double> beginPoint, Point<double> endPoint, Point<double> center);
-		virtual ~Arc() = default;
+		Arc() = default;
+		Arc(Radians beginPointAngle, Radians endPointAngle, Point<double> center, double radius, bool counterClockWise);
+		Arc(Point<double> beginPoint, Point<double> endPoint, Point<double> center, bool counterClockWise);
 
 		Point<double> getCenterPoint();									// returns the center of circle
-		inline Radians getBeginPointAngle();							// gets the angle between x coordinate and point
-		inline Radians getEndPointAngle();								// gets the angle between x coordinate and point
-		virtual bool isCounterClockWise() = 0;
-		virtual Point<double> getPeakPoint() = 0;						// returns this circle peak point
-		virtual void generateVertexes(VertexChain<double>& vertexChain, unsigned int sections) = 0;		// generates vertexes and sets it in vertexChain, so they can be displayed
+		double getRadius();
+		Radians getBeginPointAngle();									// gets the angle between x coordinate and point
+		Radians getEndPointAngle();										// gets the angle between x coordinate and point
+		bool isCounterClockWise();
+		Point<double> getPeakPoint();									// returns this circle peak point
+		double getSweep();												// returns angle from begin to end point, positive if arc is counterclockwise
+		BoundingBox<double> getBoundingBox();							// returns the smallest box around the arc (not the whole circle)
+		void addExtremes(BoundingBox<double>& box);						// adds points of arc that are the furthest in x and y directions, with begin and end point they make the smallest box
+		bool containsAngle(double angle);								// returns true when the point of circle at angle (0 to 2 pi) is on arc
+		bool projectPoint(Point<double> point, Point<double>& projection);	// sets the point of circle nearest to given one, returns false when it isn't on arc (one of arc ends is the nearest then)
+		unsigned int vertexCount(ArcAccuracy accuracy);									// returns number of vertexes that generateVertexes would add
+		void generateVertexes(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy);	// generates vertexes and sets it in vertexBuffer, so they can be displayed
+		void generateVertexes(double* xs, double* ys, ArcAccuracy accuracy);				// writes vertexCount vertexes to arrays, so many arcs can be written at once
 	};
 
 
@@ -297,9 +372,6 @@ namespace primitives
 	{
 	public:
 		ClockWiseArc(Point<double> beginPoint, Point<double> endPoint, Point<double> center);
-		bool isCounterClockWise() override;
-		Point<double> getPeakPoint() override;
-		void generateVertexes(VertexChain<double>& vertexChain, unsigned int sections) override;
 	};
 
 
@@ -308,8 +380,5 @@ namespace primitives
 	{
 	public:
 		CounterClockWiseArc(Point<double> beginPoint, Point<double> endPoint, Point<double> center);
-		bool isCounterClockWise() override;
-		Point<double> getPeakPoint() override;
-		void generateVertexes(VertexChain<double>& vertexChain, unsigned int sections) override;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "Scene.h"
+
+
+
+namespace controler
+{
+	// SceneBuilder
+
+	void SceneBuilder::invalidate()
+	{
+		polyLineValid = false;
+		previewValid = false;
+		documentValid = false;
+	}
+
+
+	void SceneBuilder::publish(PolyLineControler& polyLineControler, Camera& camera)
+	{
+		updateDocument(polyLineControler.getDocument(), polyLineControler.getArcAccuracy(), camera);
+		updatePolyLine(polyLineControler, camera);
+		updatePreview(polyLineControler, camera);
+		updateSelection(polyLineControler, camera);
+
+		auto& snapshot = snapshots.getBack();
+		snapshot.polyLine = polyLinePool.newest;
+		snapshot.preview = previewPool.newest;
+		snapshot.document = documentPool.newest;
+		snapshot.selection = selectionPool.newest;
+		snapshots.publish();
+	}
+
+
+	SceneSnapshot& SceneBuilder::takeLatest()
+	{
+		snapshots.update();
+		return snapshots.getFront();
+	}
+
+
+	bool SceneBuilder::isPublished(SceneArrays* arrays)
+	{
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			if (i == snapshots.getBackIndex()) continue;				// back snapshot is written over by the next publish
+			auto& snapshot = snapshots.getSlot(i);
+			if ((snapshot.polyLine == arrays) || (snapshot.preview == arrays) || (snapshot.document == arrays) || (snapshot.selection == arrays))
+				return true;
+		}
+		return false;
+	}
+
+
+	SceneArrays& SceneBuilder::takeFreeArrays(ArraysPool& pool)
+	{
+		if ((pool.newest == nullptr) || isPublished(pool.newest))
+		{
+			pool.newest = nullptr;
+			for (auto& arrays : pool.arrays)
+				if (!isPublished(arrays.get()))
+				{
+					pool.newest = arrays.get();
+					break;
+				}
+			if (pool.newest == nullptr)								// at most three, the newest and two published ones
+			{
+				pool.arrays.push_back(std::make_unique<SceneArrays>());
+				pool.newest = pool.arrays.back().get();
+			}
+		}
+		return *pool.newest;
+	}
+
+
+	void SceneBuilder::updatePolyLine(PolyLineControler& polyLineControler, Camera& camera)
+	{
+		auto revision = polyLineControler.getRevision();
+		if (polyLineValid && (revision == polyLineRevision)) return;
+
+		auto area = camera.visibleArea();							// parts of polyline out of window aren't generated
+		auto& modelToScreen = camera.getModelToScreen();
+
+		auto& arrays = takeFreeArrays(polyLinePool);
+		vertexBuffer.clear();
+		arrays.stripEnds.clear();
+		polyLineControler.generateVisibleVertexChain(vertexBuffer, arrays.stripEnds, area);
+		modelToScreen.apply(vertexBuffer);
+		vertexBuffer.copyInterleaved(arrays.vertexes);
+
+		peakPoints.clear();
+		polyLineControler.generateVisiblePeakPoints(peakPoints, area);
+		modelToScreen.apply(peakPoints);
+		copyPeakPoints(arrays.peakPoints);
+
+		polyLineRevision = revision;
+		polyLineValid = true;
+	}
+
+
+	void SceneBuilder::updatePreview(PolyLineControler& polyLineControler, Camera& camera)
+	{
+		auto revision = polyLineControler.getPreviewRevision();
+		auto nodesRevision = polyLineControler.getRevision();
+		if (previewValid && (revision == previewRevision) && (nodesRevision == previewPolyLineRevision)) return;
+
+		auto& modelToScreen = camera.getModelToScreen();
+
+		auto& arrays = takeFreeArrays(previewPool);
+		vertexBuffer.clear();
+		peakPoints.clear();
+		arrays.stripEnds.clear();
+		if (polyLineControler.generatePreview(vertexBuffer, peakPoints))	// preview is never longer than PreviewNode::capacity, so it isn't culled
+			arrays.stripEnds.push_back(vertexBuffer.size());
+		modelToScreen.apply(vertexBuffer);
+		vertexBuffer.copyInterleaved(arrays.vertexes);
+		modelToScreen.apply(peakPoints);
+		copyPeakPoints(arrays.peakPoints);
+
+		previewRevision = revision;
+		previewPolyLineRevision = nodesRevision;
+		previewValid = true;
+	}
+
+
+	void SceneBuilder::updateSelection(PolyLineControler& polyLineControler, Camera& camera)
+	{
+		SnapPoint node;
+		peakPoints.clear();
+		if (polyLineControler.getSelectedNode(node)) peakPoints.push_back(node.point);
+		camera.getModelToScreen().apply(peakPoints);
+		copyPeakPoints(takeFreeArrays(selectionPool).peakPoints);
+	}
+
+
+	void SceneBuilder::copyPeakPoints(vector<float>& points)
+	{
+		points.resize(2 * peakPoints.size());
+		for (size_t i = 0; i < peakPoints.size(); i++)
+		{
+			points[2 * i] = static_cast<float>(peakPoints[i].x);
+			points[2 * i + 1] = static_cast<float>(peakPoints[i].y);
+		}
+	}
+
+
+	void SceneBuilder::updateDocument(Document& document, ArcAccuracy accuracy, Camera& camera)
+	{
+		auto modelToScreen = camera.getModelToScreen();
+		auto area = camera.visibleArea();
+
+		if ((!documentValid) || (accuracy != documentAccuracy))		// all visible polylines are found in the grid again
+		{
+			auto& arrays = takeFreeArrays(documentPool);
+			arrays.vertexes.clear();
+			arrays.peakPoints.clear();
+			visiblePolyLines.clear();
+			document.findPolyLines(area, visiblePolyLines);
+			for (auto id : visiblePolyLines)
+				appendDocumentPolyLine(arrays, document.getPolyLine(id), accuracy, modelToScreen, area);
+
+			documentPolyLinesCount = document.size();
+			documentAccuracy = accuracy;
+			documentValid = true;
+			return;
+		}
+
+		SceneArrays* arrays = nullptr;
+		for (size_t id = documentPolyLinesCount; id < document.size(); id++)	// polylines are only added, so older ones stay as they are
+		{
+			if (!document.getBoundingBox(static_cast<uint32_t>(id)).intersects(area)) continue;
+			if (arrays == nullptr)									// published arrays are copied before the first new polyline is added
+			{
+				auto previous = documentPool.newest;
+				arrays = &takeFreeArrays(documentPool);
+				if (arrays != previous) *arrays = *previous;
+			}
+			visiblePolyLines.push_back(static_cast<uint32_t>(id));
+			appendDocumentPolyLine(*arrays, document.getPolyLine(static_cast<uint32_t>(id)), accuracy, modelToScreen, area);
+		}
+		documentPolyLinesCount = document.size();
+	}
+
+
+	void SceneBuilder::appendDocumentPolyLine(SceneArrays& arrays, PolyLine& polyLine, ArcAccuracy accuracy, AffineTransform& modelToScreen, BoundingBox<double>& area)
+	{
+		vertexBuffer.clear();
+		stripEnds.clear();
+		polyLine.generateVisibleVertexChain(vertexBuffer, stripEnds, accuracy, area);
+		modelToScreen.apply(vertexBuffer);
+
+		double* xs = vertexBuffer.getX();
+		double* ys = vertexBuffer.getY();
+		size_t stripBegin = 0;
+		for (auto stripEnd : stripEnds)								// line strips are turned into separate sections
+		{
+			for (size_t i = stripBegin + 1; i < stripEnd; i++)
+			{
+				arrays.vertexes.push_back(static_cast<float>(xs[i - 1]));
+				arrays.vertexes.push_back(static_cast<float>(ys[i - 1]));
+				arrays.vertexes.push_back(static_cast<float>(xs[i]));
+				arrays.vertexes.push_back(static_cast<float>(ys[i]));
+			}
+			stripBegin = stripEnd;
+		}
+
+		peakPoints.clear();
+		polyLine.generateVisiblePeakPoints(peakPoints, area);
+		modelToScreen.apply(peakPoints);
+		for (auto& peakPoint : peakPoints)
+		{
+			arrays.peakPoints.push_back(static_cast<float>(peakPoint.x));
+			arrays.peakPoints.push_back(static_cast<float>(peakPoint.y));
+		}
+	}
+}
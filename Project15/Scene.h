@@ -0,0 +1,120 @@
+#pragma once
+#include "Primitives.h"
+#include "Camera.h"
+#include "Document.h"
+#include "PolylineControler.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+
+
+namespace controler
+{
+	using namespace primitives;
+	using namespace obj;
+	using std::unique_ptr;
+	using std::vector;
+
+
+	// TripleBuffer passes values from one producer thread to one consumer thread without locks. Producer writes its back slot and publishes it,
+	// consumer takes the newest published one to its front slot. Neither waits for the other, values that consumer didn't take in time are
+	// written over. Producer can read every slot, consumer never writes them
+	template<class T>
+	class TripleBuffer
+	{
+		static const unsigned int freshFlag = 4;					// set in middle slot index when consumer hasn't taken it yet
+
+		T slots[3];
+		std::atomic<unsigned int> middle{ 1 };						// slot between producer and consumer
+		unsigned int back = 0;										// slot of producer
+		unsigned int front = 2;										// slot of consumer
+
+	public:
+		inline T& getBack() { return slots[back]; }
+		inline T& getFront() { return slots[front]; }
+		inline T& getSlot(unsigned int index) { return slots[index]; }	// producer: any of three slots, published ones only for reading
+		inline unsigned int getBackIndex() { return back; }
+		void publish()												// producer: back slot becomes the newest value, producer gets another slot
+		{
+			back = middle.exchange(back | freshFlag, std::memory_order_acq_rel) & ~freshFlag;
+		}
+		bool update()												// consumer: takes the newest value, returns false when front is the newest already
+		{
+			if ((middle.load(std::memory_order_acquire) & freshFlag) == 0) return false;
+			front = middle.exchange(front, std::memory_order_acq_rel) & ~freshFlag;
+			return true;
+		}
+	};
+
+
+
+
+	// SceneArrays are vertex arrays in screen coordinates, as gl takes them. They're never changed while a published snapshot points to them
+	struct SceneArrays
+	{
+		vector<float> vertexes;										// (x, y) pairs
+		vector<size_t> stripEnds;									// index after the last vertex of every line strip, empty for separate sections (GL_LINES)
+		vector<float> peakPoints;									// (x, y) pairs
+	};
+
+
+	// SceneSnapshot is everything that is displayed in one frame. Renderer reads only snapshots, never polylines. Arrays are empty pointers
+	// until the first snapshot is published
+	struct SceneSnapshot
+	{
+		const SceneArrays* polyLine = nullptr;						// polyline being drawn, as line strips
+		const SceneArrays* preview = nullptr;						// its display node that follows cursor, one line strip from the last node
+		const SceneArrays* document = nullptr;						// finished polylines, as separate sections
+		const SceneArrays* selection = nullptr;						// end point of selected node, in peak points
+	};
+
+
+
+
+	// SceneBuilder makes snapshots of the scene on the thread that edits polylines and publishes them to the renderer through triple buffer.
+	// Arrays are made again only when polyline, document or view has changed, otherwise the new snapshot points to the same arrays as the
+	// previous one. Mouse move changes only display node, so only its few vertexes are made then, however long the polyline is. Arrays that
+	// no published snapshot points to are used again and keep their memory, so building doesn't allocate memory after the first frames
+	class SceneBuilder
+	{
+		// ArraysPool keeps all arrays made for one part of the scene. The newest ones go to the next snapshot, the others are published or free
+		struct ArraysPool
+		{
+			vector<unique_ptr<SceneArrays>> arrays;
+			SceneArrays* newest = nullptr;
+		};
+
+		TripleBuffer<SceneSnapshot> snapshots;
+		ArraysPool polyLinePool;
+		ArraysPool previewPool;
+		ArraysPool documentPool;
+		ArraysPool selectionPool;
+
+		VertexBuffer<double> vertexBuffer;							// model coordinates, kept between frames
+		vector<Point<double>> peakPoints;
+		vector<size_t> stripEnds;
+		unsigned long polyLineRevision = 0;							// revision of polyline that current arrays were made from
+		bool polyLineValid = false;
+		unsigned long previewRevision = 0;							// preview is made again when this or polyline revision changes
+		unsigned long previewPolyLineRevision = 0;
+		bool previewValid = false;
+		vector<uint32_t> visiblePolyLines;							// ids of document polylines found in visible area
+		size_t documentPolyLinesCount = 0;							// polylines of document that are already checked, newer ones are only added to arrays
+		ArcAccuracy documentAccuracy = 0;
+		bool documentValid = false;
+
+		bool isPublished(SceneArrays* arrays);						// consumer may read arrays, because middle or front snapshot points to them
+		SceneArrays& takeFreeArrays(ArraysPool& pool);				// the newest arrays when they aren't published, otherwise other free or new ones. They become the newest
+		void updatePolyLine(PolyLineControler& polyLineControler, Camera& camera);
+		void updatePreview(PolyLineControler& polyLineControler, Camera& camera);
+		void updateSelection(PolyLineControler& polyLineControler, Camera& camera);	// made in every snapshot, it's one point
+		void copyPeakPoints(vector<float>& points);					// writes peakPoints as (x, y) pairs of floats
+		void updateDocument(Document& document, ArcAccuracy accuracy, Camera& camera);		// appends new polylines of document, all of them are found again only after view change
+		void appendDocumentPolyLine(SceneArrays& arrays, PolyLine& polyLine, ArcAccuracy accuracy, AffineTransform& modelToScreen, BoundingBox<double>& area);
+	public:
+		void invalidate();											// producer: arrays are made again for the next snapshot (ex. view has changed)
+		void publish(PolyLineControler& polyLineControler, Camera& camera);	// producer: makes snapshot of the current scene and publishes it
+		SceneSnapshot& takeLatest();								// consumer: returns the newest published snapshot, it stays valid until the next call
+	};
+}
@@ -0,0 +1,161 @@
+#include "Snapping.h"
+
+
+
+namespace obj
+{
+	// SnapIndex
+
+	SnapIndex::SnapIndex(double cellSize)
+	{
+		levels.reserve(levelsCount);
+		for (int level = 0; level < levelsCount; level++)
+		{
+			levels.emplace_back(cellSize, &cellMemory);
+			cellSize *= levelScale;
+		}
+	}
+
+
+	int64_t SnapIndex::cellCoordinate(double value, double cellSize)
+	{
+		const double limit = 1 << 28;								// cell coordinates have to fit in half of the key, far away points share border cells
+		double coordinate = std::floor(value / cellSize);
+		if (coordinate < -limit) coordinate = -limit;
+		if (coordinate > limit) coordinate = limit;
+		return static_cast<int64_t>(coordinate);
+	}
+
+
+	uint64_t SnapIndex::cellKey(int64_t x, int64_t y)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+
+	void SnapIndex::add(Point<double> point, SnapKind kind, uint32_t polyLine, uint32_t nodeIndex)
+	{
+		auto id = static_cast<uint32_t>(points.size());
+		points.push_back(SnapPoint(point, kind, polyLine, nodeIndex));
+
+		for (auto& level : levels)
+		{
+			auto key = cellKey(cellCoordinate(point.x, level.cellSize), cellCoordinate(point.y, level.cellSize));
+			level.cells[key].push_back(id);
+		}
+	}
+
+
+	void SnapIndex::addNode(NodeStore& nodes, size_t index, uint32_t polyLine)
+	{
+		auto nodeIndex = static_cast<uint32_t>(index);
+		add(nodes.getEndPointAt(index), SnapKind::EndPoint, polyLine, nodeIndex);
+		if (nodes.getKindAt(index) == NodeKind::Arc)
+		{
+			add(nodes.getArcAt(index).getCenterPoint(), SnapKind::Center, polyLine, nodeIndex);
+			add(nodes.getPeakPointAt(index), SnapKind::PeakPoint, polyLine, nodeIndex);
+		}
+	}
+
+
+	size_t SnapIndex::nodePointsCount(NodeKind kind)
+	{
+		return (kind == NodeKind::Arc) ? 3 : 1;
+	}
+
+
+	void SnapIndex::removeLast(size_t count)
+	{
+		for (; (count > 0) && (!points.empty()); count--)
+		{
+			auto point = points.back().point;
+			for (auto& level : levels)
+			{
+				auto cell = level.cells.find(cellKey(cellCoordinate(point.x, level.cellSize), cellCoordinate(point.y, level.cellSize)));
+				cell->second.pop_back();							// ids in cell rise, so the last point is at the end
+				if (cell->second.empty()) level.cells.erase(cell);
+			}
+			points.pop_back();
+		}
+	}
+
+
+	bool SnapIndex::findNearest(Point<double> point, double radius, SnapPoint& nearest)
+	{
+		return findNearest(point, radius, false, nearest);
+	}
+
+
+	bool SnapIndex::findNode(Point<double> point, double radius, SnapPoint& node)
+	{
+		return findNearest(point, radius, true, node);
+	}
+
+
+	bool SnapIndex::findNearest(Point<double> point, double radius, bool endPointsOnly, SnapPoint& nearest)
+	{
+		if (!(radius >= 0)) return false;
+
+		for (int levelIndex = 0; levelIndex < levelsCount; levelIndex++)		// levels are searched from the finest one, in growing circles
+		{
+			Level& level = levels[levelIndex];
+			double levelRadius = 2 * level.cellSize;						// circle of this radius is always in 5 x 5 cells
+			if ((levelRadius > radius) || (levelIndex == levelsCount - 1)) levelRadius = radius;
+
+			if (findNearest(level, point, levelRadius, endPointsOnly, nearest)) return true;	// all points closer than levelRadius were checked, so it's the nearest one
+			if (levelRadius == radius) return false;
+		}
+		return false;
+	}
+
+
+	bool SnapIndex::findNearest(Level& level, Point<double> point, double radius, bool endPointsOnly, SnapPoint& nearest)
+	{
+		int64_t minX = cellCoordinate(point.x - radius, level.cellSize);
+		int64_t minY = cellCoordinate(point.y - radius, level.cellSize);
+		int64_t maxX = cellCoordinate(point.x + radius, level.cellSize);
+		int64_t maxY = cellCoordinate(point.y + radius, level.cellSize);
+
+		double nearestDistance = radius * radius;					// squared, points exactly on radius are found too
+		bool found = false;
+		if (static_cast<uint64_t>(maxX - minX + 1) * static_cast<uint64_t>(maxY - minY + 1) * cellQueryCost > points.size())
+		{
+			for (auto& snapPoint : points)
+			{
+				if (endPointsOnly && (snapPoint.kind != SnapKind::EndPoint)) continue;
+				double distanceX = snapPoint.point.x - point.x;
+				double distanceY = snapPoint.point.y - point.y;
+				double distance = distanceX * distanceX + distanceY * distanceY;
+				if (distance <= nearestDistance)
+				{
+					nearestDistance = distance;
+					nearest = snapPoint;
+					found = true;
+				}
+			}
+			return found;
+		}
+
+		for (int64_t x = minX; x <= maxX; x++)
+			for (int64_t y = minY; y <= maxY; y++)
+			{
+				auto cell = level.cells.find(cellKey(x, y));
+				if (cell == level.cells.end()) continue;
+
+				for (uint32_t id : cell->second)
+				{
+					if (endPointsOnly && (points[id].kind != SnapKind::EndPoint)) continue;
+					double distanceX = points[id].point.x - point.x;
+					double distanceY = points[id].point.y - point.y;
+					double distance = distanceX * distanceX + distanceY * distanceY;
+					if (distance <= nearestDistance)
+					{
+						nearestDistance = distance;
+						nearest = points[id];
+						found = true;
+					}
+				}
+			}
+		return found;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Primitives.h"
+#include "Polyline.h"
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+
+
+namespace obj
+{
+	enum class SnapKind : unsigned char
+	{
+		EndPoint,													// end point of node (also the first node)
+		Center,														// center of arc
+		PeakPoint													// peak point of arc
+	};
+
+
+	struct SnapPoint
+	{
+		Point<double> point;
+		SnapKind kind;
+		uint32_t polyLine;											// id of polyline in document, the one being drawn gets the next id
+		uint32_t nodeIndex;											// node that point belongs to
+
+		SnapPoint() = default;
+		SnapPoint(Point<double> point, SnapKind kind, uint32_t polyLine = 0, uint32_t nodeIndex = 0) : point(point), kind(kind), polyLine(polyLine), nodeIndex(nodeIndex) {}
+	};
+
+
+
+
+	// SnapIndex finds the nearest point that cursor can snap to, or the node under cursor. Points are kept in uniform grids of a few levels, every level has cells
+	// levelScale times bigger than the previous one. A query looks into 5 x 5 cells of the finest level and goes to the coarser one
+	// only when nothing was found there, so dense drawings seen from far away are searched as fast as close ones. When radius covers more cells
+	// than it would take to check all points (coarsest level, big radius), all points are checked instead.
+	// Points are added and removed like on a stack (nodes are appended and undone), so removing is O(1):
+	// the last point is always the last one in its cells. Cells are allocated from the index's own pool, so adding nodes and undoing them
+	// takes memory from global heap only when the pool grows
+	class SnapIndex
+	{
+		static const int levelsCount = 4;
+		static const int levelScale = 8;
+		static const uint64_t cellQueryCost = 8;					// looking into one cell takes about as long as checking 8 points (hash lookup)
+
+		struct Level
+		{
+			double cellSize;
+			std::pmr::unordered_map<uint64_t, std::pmr::vector<uint32_t>> cells;	// ids of points in every cell that isn't empty
+
+			Level(double cellSize, std::pmr::memory_resource* memory) : cellSize(cellSize), cells(memory) {}
+		};
+
+		std::pmr::unsynchronized_pool_resource cellMemory;			// index is used only by the thread that edits polylines. Declared first, so it outlives cells
+		vector<Level> levels;										// levelsCount levels, from the finest one
+		vector<SnapPoint> points;
+
+		inline int64_t cellCoordinate(double value, double cellSize);
+		inline uint64_t cellKey(int64_t x, int64_t y);
+		bool findNearest(Level& level, Point<double> point, double radius, bool endPointsOnly, SnapPoint& nearest);	// checks only cells of given level, or all points when there are less of them than cells
+		bool findNearest(Point<double> point, double radius, bool endPointsOnly, SnapPoint& nearest);
+	public:
+		static constexpr double defaultCellSize = 1.0 / 64;			// model units of the finest level, the window is 2 units high
+
+		SnapIndex(double cellSize = defaultCellSize);
+		SnapIndex(const SnapIndex&) = delete;
+		void add(Point<double> point, SnapKind kind, uint32_t polyLine = 0, uint32_t nodeIndex = 0);
+		void addNode(NodeStore& nodes, size_t index, uint32_t polyLine);	// adds end point of node, and center and peak point of arc
+		void removeLast(size_t count = 1);							// removes points that were added last
+		static size_t nodePointsCount(NodeKind kind);				// returns number of points that addNode adds for node of given kind
+		inline size_t size() { return points.size(); }
+		bool findNearest(Point<double> point, double radius, SnapPoint& nearest);	// returns false when no point is within radius
+		bool findNode(Point<double> point, double radius, SnapPoint& node);		// the same for end points only, node is the one under cursor
+	};
+}
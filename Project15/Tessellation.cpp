@@ -0,0 +1,116 @@
+#include "Tessellation.h"
+
+
+namespace primitives
+{
+	// ArcAccuracy
+
+	ArcAccuracy::ArcAccuracy(unsigned int sections)
+		:	sections(sections),
+			maxDeviation(0)
+	{	}
+
+
+	ArcAccuracy ArcAccuracy::fromDeviation(double maxDeviation)
+	{
+		auto accuracy = ArcAccuracy(maxSections);
+		accuracy.maxDeviation = maxDeviation;
+		return accuracy;
+	}
+
+
+	double ArcAccuracy::maxStep(double radius)
+	{
+		double minStep = 2 * pi / maxSections;
+		if (maxDeviation <= 0) return 2 * pi / sections;
+		if (2 * radius <= maxDeviation) return 2 * pi;				// whole arc is closer to its chord than deviation (ex. it's smaller than a pixel), so only the end point is drawn
+		if (maxDeviation >= radius) return pi / 2;					// arc smaller than deviation is still drawn with quarter sections, so it doesn't look like a line
+
+		double step = 2 * acos(1 - maxDeviation / radius);			// sagitta of section: radius * (1 - cos(step / 2))
+		if (step < minStep) return minStep;
+		if (step > pi / 2) return pi / 2;
+		return step;
+	}
+
+
+	bool operator == (const ArcAccuracy& first, const ArcAccuracy& last)
+	{
+		return ((first.sections == last.sections) && (first.maxDeviation == last.maxDeviation));
+	}
+
+
+	bool operator != (const ArcAccuracy& first, const ArcAccuracy& last)
+	{
+		return !(first == last);
+	}
+
+
+
+
+	// ArcTessellator
+
+	ArcTessellator::ArcTessellator(Point<double> center, double radius, Radians beginAngle, double sweep)
+		:	center(center),
+			radius(radius),
+			beginAngle(beginAngle.value),
+			sweep(sweep)
+	{	}
+
+
+	double ArcTessellator::step(ArcAccuracy& accuracy)
+	{
+		double maxStep = accuracy.maxStep(radius);
+		if (accuracy.maxDeviation <= 0) return maxStep;
+
+		double steps = ceil(fabs(sweep) / maxStep);
+		if (steps < 1) return maxStep;
+		return fabs(sweep) / steps;
+	}
+
+
+	unsigned int ArcTessellator::vertexCount(ArcAccuracy accuracy)
+	{
+		double steps = ceil(fabs(sweep) / step(accuracy) - 1e-9);		// vertexes lie on every full step that is smaller than sweep, and on the end point
+
+		if (steps < 1) return 1;
+		return static_cast<unsigned int>(steps);
+	}
+
+
+	void ArcTessellator::generateVertexes(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy)
+	{
+		size_t first = vertexBuffer.size();
+		vertexBuffer.grow(vertexCount(accuracy));
+		generateVertexes(vertexBuffer.getX() + first, vertexBuffer.getY() + first, accuracy);
+	}
+
+
+	void ArcTessellator::generateVertexes(double* xs, double* ys, ArcAccuracy accuracy)
+	{
+		double sectionAngle = step(accuracy);
+		double stepCosinus = cos(sectionAngle);
+		double stepSinus = (sweep < 0) ? -sin(sectionAngle) : sin(sectionAngle);		// clockwise arcs are rotated backwards
+		double inversedSquareRadius = 1 / (radius * radius);
+
+		double x = radius * cos(beginAngle);
+		double y = radius * sin(beginAngle);
+
+		unsigned int middleVertexes = vertexCount(accuracy) - 1;
+		for (unsigned int i = 0; i < middleVertexes; i++)
+		{
+			double rotatedX = x * stepCosinus - y * stepSinus;
+			double rotatedY = x * stepSinus + y * stepCosinus;
+
+			double correction = (3 - (rotatedX * rotatedX + rotatedY * rotatedY) * inversedSquareRadius) / 2;	// one newton step of 1/sqrt, keeps vertex on the circle
+			x = rotatedX * correction;
+			y = rotatedY * correction;
+
+			xs[i] = center.x + x;
+			ys[i] = center.y + y;
+		}
+
+		double endAngle = beginAngle + sweep;											// end point is computed directly, so the arc always ends exactly where it should
+		xs[middleVertexes] = center.x + radius * cos(endAngle);
+		ys[middleVertexes] = center.y + radius * sin(endAngle);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Primitives.h"
+
+
+
+namespace primitives
+{
+	// ArcAccuracy says how finely arcs are approximated. Either every circle is divided on the same number of sections,
+	// or the biggest distance between arc and its chord (sagitta) is given, so the number of sections depends on arc radius
+	struct ArcAccuracy
+	{
+		static const unsigned int maxSections = 65536;		// limit of sections per whole circle, for very small deviations
+
+		unsigned int sections;								// sections per whole 360 deg circle, used when maxDeviation is 0
+		double maxDeviation;								// the biggest allowed distance between arc and chord, in model units
+
+		ArcAccuracy(unsigned int sections);
+		static ArcAccuracy fromDeviation(double maxDeviation);
+		double maxStep(double radius);						// returns the biggest angle of one section of arc with given radius
+		friend bool operator == (const ArcAccuracy& first, const ArcAccuracy& last);
+		friend bool operator != (const ArcAccuracy& first, const ArcAccuracy& last);
+	};
+
+
+
+	// ArcTessellator turns an arc into vertexes. Sinus and cosinus of the step are computed once per arc,
+	// then every vertex is made by rotating the previous one (rotation recurrence), so there is no trigonometry in the loop.
+	// Vertex length is corrected in every step, so rounding errors don't make the arc spiral in or out.
+	// Tolerance: vertexes differ from the per vertex sin/cos version by less than 1e-11 * radius (measured up to 4096 sections per circle in Benchmarks/ArcTessellationBenchmark.cpp)
+	class ArcTessellator
+	{
+		Point<double> center;
+		double radius;
+		double beginAngle;
+		double sweep;							// angle from begin to end point: positive counterclockwise, negative clockwise
+
+		double step(ArcAccuracy& accuracy);		// angle between two vertexes. Fixed sections leave shorter last section, deviation divides arc evenly
+	public:
+		ArcTessellator(Point<double> center, double radius, Radians beginAngle, double sweep);
+
+		unsigned int vertexCount(ArcAccuracy accuracy);										// number of vertexes that generateVertexes adds (with the end point)
+		void generateVertexes(VertexBuffer<double>& vertexBuffer, ArcAccuracy accuracy);		// adds vertexes after begin point up to the end point
+		void generateVertexes(double* xs, double* ys, ArcAccuracy accuracy);					// the same, written to arrays that have room for vertexCount vertexes
+	};
+}
@@ -0,0 +1,135 @@
+#include "ThreadPool.h"
+
+
+
+namespace primitives
+{
+	// WorkStealingPool
+
+	WorkStealingPool::WorkStealingPool(unsigned int threadsCount)
+	{
+		if (threadsCount == 0) threadsCount = std::thread::hardware_concurrency();
+		if (threadsCount == 0) threadsCount = 1;
+
+		for (unsigned int worker = 0; worker < threadsCount; worker++)
+			queues.push_back(unique_ptr<Queue>(new Queue()));
+		for (unsigned int worker = 1; worker < threadsCount; worker++)
+			threads.emplace_back(&WorkStealingPool::workerLoop, this, worker);
+	}
+
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		jobStarted.notify_all();
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+
+	bool WorkStealingPool::takeRange(size_t worker, Range& range)
+	{
+		{
+			Queue& queue = *queues[worker];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.ranges.empty())
+			{
+				range = queue.ranges.front();
+				queue.ranges.pop_front();
+				return true;
+			}
+		}
+
+		for (size_t i = 1; i < queues.size(); i++)				// victims are checked from the next worker, so thieves don't all go to the same queue
+		{
+			Queue& queue = *queues[(worker + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.ranges.empty())
+			{
+				range = queue.ranges.back();
+				queue.ranges.pop_back();
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	void WorkStealingPool::work(size_t worker, const std::function<void(size_t, size_t)>& job)
+	{
+		Range range;
+		while (takeRange(worker, range))
+		{
+			job(range.begin, range.end);
+			if (pendingRanges.fetch_sub(1) == 1)
+			{
+				std::lock_guard<std::mutex> lock(mutex);			// caller may be just going to sleep, lock makes sure it gets the notification
+				jobFinished.notify_all();
+			}
+		}
+	}
+
+
+	void WorkStealingPool::workerLoop(size_t worker)
+	{
+		size_t doneJobIndex = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			jobStarted.wait(lock, [&] { return stopping || (jobIndex != doneJobIndex); });
+			if (stopping) return;
+
+			doneJobIndex = jobIndex;
+			activeWorkers++;
+			auto job = body;
+			lock.unlock();
+
+			if (job != nullptr) work(worker, *job);
+
+			lock.lock();
+			activeWorkers--;
+			if (activeWorkers == 0) jobFinished.notify_all();
+		}
+	}
+
+
+	void WorkStealingPool::parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& job)
+	{
+		if (begin >= end) return;
+		if (grain == 0) grain = 1;
+		size_t rangesCount = (end - begin + grain - 1) / grain;
+		if ((queues.size() == 1) || (rangesCount == 1))
+		{
+			for (size_t first = begin; first < end; first += grain)
+				job(first, (end - first > grain) ? first + grain : end);
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		for (size_t worker = 0; worker < queues.size(); worker++)	// every worker gets neighbouring ranges, so it goes through memory in order
+		{
+			size_t firstRange = rangesCount * worker / queues.size();
+			size_t endRange = rangesCount * (worker + 1) / queues.size();
+			std::lock_guard<std::mutex> queueLock(queues[worker]->mutex);
+			for (size_t range = firstRange; range < endRange; range++)
+			{
+				size_t first = begin + range * grain;
+				queues[worker]->ranges.push_back(Range{ first, (end - first > grain) ? first + grain : end });
+			}
+		}
+		pendingRanges = rangesCount;
+		body = &job;
+		jobIndex++;
+		lock.unlock();
+		jobStarted.notify_all();
+
+		work(0, job);
+
+		lock.lock();												// workers that woke up late can still hold the job, it has to live until they let it go
+		jobFinished.wait(lock, [&] { return (pendingRanges == 0) && (activeWorkers == 0); });
+		body = nullptr;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+namespace primitives
+{
+	using std::vector;
+	using std::unique_ptr;
+
+
+	// WorkStealingPool runs loops on threads that are started once. Every worker gets its own queue with neighbouring ranges of the loop,
+	// takes them from the front and when its queue is empty it steals from the back of the others, so workers that got cheap ranges
+	// (ex. lines instead of arcs) help the ones with expensive ranges. The thread that calls parallelFor is worker 0 and works too
+	class WorkStealingPool
+	{
+		struct Range
+		{
+			size_t begin;
+			size_t end;
+		};
+
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Range> ranges;
+		};
+
+		vector<std::thread> threads;
+		vector<unique_ptr<Queue>> queues;								// one for every worker, with the calling thread
+		const std::function<void(size_t, size_t)>* body = nullptr;		// loop that is running now
+		std::mutex mutex;												// guards body, jobIndex, activeWorkers and stopping
+		std::condition_variable jobStarted;
+		std::condition_variable jobFinished;
+		size_t jobIndex = 0;											// rises with every loop, so sleeping workers know there's a new one
+		size_t activeWorkers = 0;										// workers that may still take ranges of the current loop
+		std::atomic<size_t> pendingRanges{ 0 };
+		bool stopping = false;
+
+		bool takeRange(size_t worker, Range& range);					// from own queue first, then steals from the others
+		void work(size_t worker, const std::function<void(size_t, size_t)>& job);
+		void workerLoop(size_t worker);
+	public:
+		explicit WorkStealingPool(unsigned int threadsCount = 0);		// number of workers with the calling thread, 0 uses all cores
+		~WorkStealingPool();
+		WorkStealingPool(const WorkStealingPool&) = delete;
+
+		inline unsigned int size() { return static_cast<unsigned int>(queues.size()); }
+		void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& job);
+																		// calls job(first, last) on ranges of at most grain indexes that cover [begin, end),
+																		// returns when all are done. Job can't throw, ranges run in any order
+	};
+}
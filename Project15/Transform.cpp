@@ -0,0 +1,195 @@
+#include "Transform.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define TRANSFORM_SIMD
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define TARGET_AVX2
+	#else
+		#define TARGET_AVX2 __attribute__((target("avx2,fma")))		// only this function is compiled with avx2, the rest works on every x64 processor
+	#endif
+#endif
+
+
+namespace primitives
+{
+	// batch kernels, every one transforms count points from x and y arrays in place
+
+	static void transformScalar(const AffineTransform& transform, double* x, double* y, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			double pointX = x[i];
+			double pointY = y[i];
+			x[i] = transform.xx * pointX + transform.xy * pointY + transform.dx;
+			y[i] = transform.yx * pointX + transform.yy * pointY + transform.dy;
+		}
+	}
+
+
+#ifdef TRANSFORM_SIMD
+
+	static void transformSSE2(const AffineTransform& transform, double* x, double* y, size_t count)
+	{
+		__m128d xx = _mm_set1_pd(transform.xx), xy = _mm_set1_pd(transform.xy), dx = _mm_set1_pd(transform.dx);
+		__m128d yx = _mm_set1_pd(transform.yx), yy = _mm_set1_pd(transform.yy), dy = _mm_set1_pd(transform.dy);
+
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128d pointX = _mm_loadu_pd(x + i);
+			__m128d pointY = _mm_loadu_pd(y + i);
+			_mm_storeu_pd(x + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(xx, pointX), _mm_mul_pd(xy, pointY)), dx));
+			_mm_storeu_pd(y + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(yx, pointX), _mm_mul_pd(yy, pointY)), dy));
+		}
+
+		transformScalar(transform, x + i, y + i, count - i);
+	}
+
+
+	TARGET_AVX2 static void transformAVX2(const AffineTransform& transform, double* x, double* y, size_t count)
+	{
+		__m256d xx = _mm256_set1_pd(transform.xx), xy = _mm256_set1_pd(transform.xy), dx = _mm256_set1_pd(transform.dx);
+		__m256d yx = _mm256_set1_pd(transform.yx), yy = _mm256_set1_pd(transform.yy), dy = _mm256_set1_pd(transform.dy);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256d pointX = _mm256_loadu_pd(x + i);
+			__m256d pointY = _mm256_loadu_pd(y + i);
+			_mm256_storeu_pd(x + i, _mm256_fmadd_pd(xx, pointX, _mm256_fmadd_pd(xy, pointY, dx)));
+			_mm256_storeu_pd(y + i, _mm256_fmadd_pd(yx, pointX, _mm256_fmadd_pd(yy, pointY, dy)));
+		}
+
+		transformScalar(transform, x + i, y + i, count - i);
+	}
+
+
+	static bool processorSupportsAVX2()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		__cpuid(info, 1);
+		bool fma = (info[2] & (1 << 12)) != 0;
+		bool osSavesRegisters = (info[2] & (1 << 27)) != 0;
+		if ((!fma) || (!osSavesRegisters)) return false;
+		if ((_xgetbv(0) & 6) != 6) return false;								// system has to save ymm registers
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"));
+#endif
+	}
+
+#endif
+
+
+
+
+	// AffineTransform
+
+	AffineTransform::AffineTransform()
+		:	xx(1), xy(0), dx(0),
+			yx(0), yy(1), dy(0)
+	{	}
+
+
+	AffineTransform::AffineTransform(double xx, double xy, double dx, double yx, double yy, double dy)
+		:	xx(xx), xy(xy), dx(dx),
+			yx(yx), yy(yy), dy(dy)
+	{	}
+
+
+	AffineTransform AffineTransform::scaling(double scaleX, double scaleY)
+	{
+		return AffineTransform(scaleX, 0, 0, 0, scaleY, 0);
+	}
+
+
+	AffineTransform AffineTransform::translation(double moveX, double moveY)
+	{
+		return AffineTransform(1, 0, moveX, 0, 1, moveY);
+	}
+
+
+	AffineTransform AffineTransform::rotation(Radians angle)
+	{
+		double sinus = angle.sinus();
+		double cosinus = angle.cosinus();
+		return AffineTransform(cosinus, -sinus, 0, sinus, cosinus, 0);
+	}
+
+
+	AffineTransform operator*(const AffineTransform& first, const AffineTransform& last)
+	{
+		return AffineTransform(
+			first.xx * last.xx + first.xy * last.yx, first.xx * last.xy + first.xy * last.yy, first.xx * last.dx + first.xy * last.dy + first.dx,
+			first.yx * last.xx + first.yy * last.yx, first.yx * last.xy + first.yy * last.yy, first.yx * last.dx + first.yy * last.dy + first.dy);
+	}
+
+
+	AffineTransform AffineTransform::inverse()
+	{
+		double determinant = xx * yy - xy * yx;
+		double inverseXX = yy / determinant, inverseXY = -xy / determinant;
+		double inverseYX = -yx / determinant, inverseYY = xx / determinant;
+		return AffineTransform(
+			inverseXX, inverseXY, -(inverseXX * dx + inverseXY * dy),
+			inverseYX, inverseYY, -(inverseYX * dx + inverseYY * dy));
+	}
+
+
+	InstructionSet AffineTransform::bestInstructionSet()
+	{
+#ifdef TRANSFORM_SIMD
+		static const InstructionSet best = processorSupportsAVX2() ? InstructionSet::AVX2 : InstructionSet::SSE2;	// every x64 processor has SSE2
+		return best;
+#else
+		return InstructionSet::Scalar;
+#endif
+	}
+
+
+	void AffineTransform::apply(vector<Point<double>>& points)
+	{
+		for (auto& point : points)
+			point = apply(point);
+	}
+
+
+	void AffineTransform::apply(VertexBuffer<double>& vertexBuffer)
+	{
+		apply(vertexBuffer, bestInstructionSet());
+	}
+
+
+	void AffineTransform::apply(VertexBuffer<double>& vertexBuffer, InstructionSet instructionSet)
+	{
+		if (instructionSet > bestInstructionSet())
+			instructionSet = bestInstructionSet();
+
+		double* x = vertexBuffer.getX();
+		double* y = vertexBuffer.getY();
+		size_t count = vertexBuffer.size();
+
+		switch (instructionSet)
+		{
+#ifdef TRANSFORM_SIMD
+		case InstructionSet::AVX2:
+			transformAVX2(*this, x, y, count);
+			break;
+		case InstructionSet::SSE2:
+			transformSSE2(*this, x, y, count);
+			break;
+#endif
+		default:
+			transformScalar(*this, x, y, count);
+			break;
+		}
+	}
+}
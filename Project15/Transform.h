@@ -0,0 +1,42 @@
+#pragma once
+#include "Primitives.h"
+
+
+
+namespace primitives
+{
+	// instruction sets that batch transforms can use, the best one available is chosen at runtime
+	enum class InstructionSet
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+
+
+	// AffineTransform maps point (x, y) to (xx * x + xy * y + dx, yx * x + yy * y + dy). It's used for model to screen mapping,
+	// so scaling, moving and rotating are the same multiply-add for every point. Whole vertex buffers are transformed in batches with SIMD
+	struct AffineTransform
+	{
+		double xx, xy, dx;
+		double yx, yy, dy;
+
+		AffineTransform();																	// sets identity
+		AffineTransform(double xx, double xy, double dx, double yx, double yy, double dy);
+		static AffineTransform scaling(double scaleX, double scaleY);
+		static AffineTransform translation(double moveX, double moveY);
+		static AffineTransform rotation(Radians angle);
+		friend AffineTransform operator*(const AffineTransform& first, const AffineTransform& last);	// first applied after last
+		AffineTransform inverse();															// returns mapping back, transform can't be singular (ex. scaling by 0)
+
+		static InstructionSet bestInstructionSet();											// checks processor once and returns the fastest supported instruction set
+		inline Point<double> apply(Point<double> point)
+		{
+			return Point<double>(xx * point.x + xy * point.y + dx, yx * point.x + yy * point.y + dy);
+		}
+		void apply(vector<Point<double>>& points);
+		void apply(VertexBuffer<double>& vertexBuffer);										// transforms whole buffer in place with the best instruction set
+		void apply(VertexBuffer<double>& vertexBuffer, InstructionSet instructionSet);
+	};
+}
@@ -1,6 +1,8 @@
 #include "glut.h"
 #include "Controler.h"
-#include <Windows.h>
+#ifdef _WIN32
+	#include <Windows.h>
+#endif
 #include <string>
 
 
@@ -9,7 +11,11 @@ using namespace controler;
 using std::string;
 
 
+#ifdef _WIN32
 int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+#else
+int main()
+#endif
 {
 	int argc = 1;																								// setting up unused parameters
 	char *argv[1] = { (char*)"" };
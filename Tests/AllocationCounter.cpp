@@ -0,0 +1,70 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+
+
+namespace allocationCounter										// helpers of the replacements below, only this file uses them
+{
+	static void* allocate(size_t size)
+	{
+		allocationsCount.fetch_add(1, std::memory_order_relaxed);
+		return std::malloc((size > 0) ? size : 1);
+	}
+
+	static void* allocate(size_t size, std::align_val_t alignment)
+	{
+		allocationsCount.fetch_add(1, std::memory_order_relaxed);
+		auto align = static_cast<size_t>(alignment);
+		size = (size + align - 1) / align * align;					// aligned_alloc takes only multiples of alignment
+		if (size == 0) size = align;
+#ifdef _MSC_VER
+		return _aligned_malloc(size, align);
+#else
+		return std::aligned_alloc(align, size);
+#endif
+	}
+
+	static void free(void* memory)
+	{
+		std::free(memory);
+	}
+
+	static void freeAligned(void* memory)
+	{
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+
+	static void* checked(void* memory)								// throwing forms of new
+	{
+		if (memory == nullptr) throw std::bad_alloc();
+		return memory;
+	}
+}
+
+
+void* operator new(size_t size) { return allocationCounter::checked(allocationCounter::allocate(size)); }
+void* operator new[](size_t size) { return allocationCounter::checked(allocationCounter::allocate(size)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocationCounter::allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocationCounter::allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocationCounter::checked(allocationCounter::allocate(size, alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocationCounter::checked(allocationCounter::allocate(size, alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocationCounter::allocate(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocationCounter::allocate(size, alignment); }
+
+void operator delete(void* memory) noexcept { allocationCounter::free(memory); }
+void operator delete[](void* memory) noexcept { allocationCounter::free(memory); }
+void operator delete(void* memory, size_t) noexcept { allocationCounter::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { allocationCounter::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { allocationCounter::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { allocationCounter::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { allocationCounter::freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { allocationCounter::freeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { allocationCounter::freeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { allocationCounter::freeAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { allocationCounter::freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { allocationCounter::freeAligned(memory); }
@@ -0,0 +1,10 @@
+// AllocationCounter counts allocations from global heap, so tests and benchmarks can check that hot paths take no memory.
+// AllocationCounter.cpp replaces every form of global operator new and delete (plain, array, sized, aligned and nothrow), so memory
+// is always freed by the same allocator that gave it. Programs that count allocations compile it with their own sources
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+
+
+inline std::atomic<size_t> allocationsCount{ 0 };
@@ -0,0 +1,49 @@
+// Passive mouse moves snap the cursor, make the display arc again and publish the scene snapshot, which display takes. After the
+// first frames have grown all arrays and pools, none of it may take memory from global heap
+
+#include "Check.h"
+#include "AllocationCounter.h"
+#include "Drawing.h"
+#include "Scene.h"
+#include <vector>
+
+
+using namespace controler;
+using namespace tests;
+
+
+
+void checkMouseTracking()
+{
+	auto points = createRandomWalk(10000, 3);
+	auto cursors = createRandomWalk(1024, 4);
+	HistoryHandler historyHandler;
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+	drawNodes(polyLineControler, points);
+	polyLineControler.startAddingArcs();
+
+	Camera camera(Size<double>(1024, 768), 384);
+	SceneBuilder sceneBuilder;
+	auto moveMouse = [&](size_t i)
+	{
+		auto cursor = polyLineControler.snap(cursors[i], 8 * camera.getPixelSize());
+		polyLineControler.actualizePolyLine(cursor);
+		sceneBuilder.publish(polyLineControler, camera);
+		CHECK(sceneBuilder.takeLatest().preview != nullptr);
+	};
+	for (size_t i = 0; i < cursors.size(); i++)					// every cursor once, so all arrays have grown already
+		moveMouse(i);
+
+	size_t firstAllocationsCount = allocationsCount;
+	for (size_t i = 0; i < cursors.size(); i++)
+		moveMouse(cursors.size() - 1 - i);
+	CHECK(allocationsCount == firstAllocationsCount);
+}
+
+
+int main()
+{
+	checkMouseTracking();
+	return tests::result();
+}
@@ -0,0 +1,32 @@
+// Tests of the core library are plain programs, so they build wherever the library does. A failed check prints where it was
+// and the test returns non-zero, which ctest reports as failure
+#pragma once
+#include <cstdio>
+
+
+
+namespace tests
+{
+	inline int& failuresCount()
+	{
+		static int count = 0;
+		return count;
+	}
+
+	inline int result()											// value returned from main
+	{
+		if (failuresCount() > 0) std::printf("%d checks failed\n", failuresCount());
+		return (failuresCount() == 0) ? 0 : 1;
+	}
+}
+
+
+#define CHECK(condition)																		\
+	do																							\
+	{																							\
+		if (!(condition))																		\
+		{																						\
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);			\
+			tests::failuresCount()++;															\
+		}																						\
+	} while (false)
@@ -0,0 +1,72 @@
+// Closest point query walks the box hierarchy and measures true arcs, so it's compared with brute force over all sections of
+// finely tessellated polyline. Chords lie at most maxDeviation from their arcs, so both answers can differ only by that much
+
+#include "Check.h"
+#include "Drawing.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+
+using namespace obj;
+using namespace tests;
+
+const double maxDeviation = 1e-7;
+
+
+
+double bruteForceDistance(VertexBuffer<double>& vertexes, Point<double>& point)
+{
+	double nearest = std::numeric_limits<double>::infinity();
+	for (size_t i = 0; i + 1 < vertexes.size(); i++)
+	{
+		auto begin = vertexes[i];
+		auto end = vertexes[i + 1];
+		auto closest = Section<double>(begin, end).getClosestPoint(point);
+		nearest = std::fmin(nearest, std::hypot(closest.x - point.x, closest.y - point.y));
+	}
+	return nearest;
+}
+
+
+void checkClosestPoints()
+{
+	WorkStealingPool pool(4);
+	auto first = Point<double>(0, 0);
+	PolyLine polyLine(first);
+	polyLine.setTessellationPool(&pool);
+	auto points = createRandomWalk(600, 5);
+	drawNodes(polyLine, points, 3, 50);							// with removed nodes, so their boxes have to be forgotten
+
+	VertexBuffer<double> vertexes;
+	polyLine.generateVertexChain(vertexes, ArcAccuracy::fromDeviation(maxDeviation));
+
+	std::mt19937 generator(11);
+	std::uniform_real_distribution<double> coordinate(-2, 2);
+	vector<Point<double>> queries;
+	for (int i = 0; i < 4000; i++)									// more than one range of pool
+	{
+		double scale = (i % 2 == 0) ? 0.05 : 1;					// half of points lie close to the polyline, where nodes are dense
+		queries.push_back(Point<double>(scale * coordinate(generator), scale * coordinate(generator)));
+	}
+
+	vector<ClosestPoint> closestPoints;
+	polyLine.findClosestPoints(queries, closestPoints);
+	CHECK(closestPoints.size() == queries.size());
+
+	for (size_t i = 0; (i < queries.size()) && (i < closestPoints.size()); i++)
+	{
+		auto closest = polyLine.findClosestPoint(queries[i]);
+		if (i < 200) CHECK(std::fabs(closest.distance - bruteForceDistance(vertexes, queries[i])) <= 2 * maxDeviation);
+		CHECK(std::fabs(std::hypot(closest.point.x - queries[i].x, closest.point.y - queries[i].y) - closest.distance) <= 1e-12);
+		CHECK(closest.nodeIndex < polyLine.getNodes().size());
+		CHECK((closestPoints[i].distance == closest.distance) && (closestPoints[i].nodeIndex == closest.nodeIndex));	// queries on pool give the same answers
+	}
+}
+
+
+int main()
+{
+	checkClosestPoints();
+	return tests::result();
+}
@@ -0,0 +1,66 @@
+// Polylines drawn by tests. Points come from seeded generators, so every run checks the same shapes
+#pragma once
+#include "PolylineControler.h"
+#include <random>
+#include <vector>
+
+
+
+namespace tests
+{
+	using primitives::Point;
+	using std::vector;
+
+
+	inline vector<Point<double>> createRandomWalk(size_t count, unsigned int seed)	// short steps pulled to the center, like nodes clicked one after another
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<double> move(-0.05, 0.05);
+
+		vector<Point<double>> points;
+		points.reserve(count);
+		auto point = Point<double>(0, 0);
+		for (size_t i = 0; i < count; i++)
+		{
+			point = Point<double>(0.95 * point.x + move(generator), 0.95 * point.y + move(generator));
+			points.push_back(point);
+		}
+		return points;
+	}
+
+
+	inline vector<Point<double>> createRandomPoints(size_t count, unsigned int seed)	// anywhere in the square from -1 to 1, so sections are long and cross
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<double> coordinate(-1, 1);
+
+		vector<Point<double>> points;
+		points.reserve(count);
+		for (size_t i = 0; i < count; i++)
+			points.push_back(Point<double>(coordinate(generator), coordinate(generator)));
+		return points;
+	}
+
+
+	// adds node i as arc when i % arcsEvery == 1, as line otherwise. With removeEvery, every removeEvery-th node is removed right after it's added
+	inline void drawNodes(obj::PolyLine& polyLine, vector<Point<double>>& points, size_t arcsEvery = 2, size_t removeEvery = 0)
+	{
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			if (i % arcsEvery == 1) polyLine.addArc(points[i]);
+			else polyLine.addLine(points[i]);
+			if ((removeEvery > 0) && (i % removeEvery == removeEvery - 1)) polyLine.removeLastNode();
+		}
+	}
+
+
+	inline void drawNodes(controler::PolyLineControler& polyLineControler, vector<Point<double>>& points)	// the same through controler, so nodes go to history
+	{
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			if (i % 3 == 0) polyLineControler.startAddingLines();
+			else polyLineControler.startAddingArcs();
+			polyLineControler.addNode(points[i]);
+		}
+	}
+}
@@ -0,0 +1,123 @@
+// DXF files: polyline written and read back has the same nodes (numbers are written with full precision, arcs are made again
+// from bulges, so they can differ by rounding), closed LWPOLYLINE gets the closing node, and damaged groups are reported
+
+#include "Check.h"
+#include "Drawing.h"
+#include "DxfFile.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+
+using namespace obj;
+using namespace tests;
+using std::string;
+
+
+
+const string path = "DxfFileTest.dxf";
+const double tolerance = 1e-9;
+
+
+unique_ptr<PolyLine> createPolyLine(size_t count)
+{
+	auto firstPoint = Point<double>(0, 0);
+	auto polyLine = make_unique<PolyLine>(firstPoint);
+	auto points = createRandomWalk(count, 3);
+	drawNodes(*polyLine, points);
+	return polyLine;
+}
+
+
+bool closePoints(Point<double> first, Point<double> last, double scale)
+{
+	return (std::fabs(first.x - last.x) <= tolerance * scale) && (std::fabs(first.y - last.y) <= tolerance * scale);
+}
+
+
+bool sameNodes(NodeStore& first, NodeStore& last)
+{
+	if (first.size() != last.size()) return false;
+	for (size_t i = 0; i < first.size(); i++)
+	{
+		if (first.getKindAt(i) != last.getKindAt(i)) return false;
+		if (!closePoints(first.getEndPointAt(i), last.getEndPointAt(i), 1)) return false;
+		if (first.getKindAt(i) != NodeKind::Arc) continue;
+
+		auto& firstArc = first.getArcAt(i);
+		auto& lastArc = last.getArcAt(i);
+		double radius = firstArc.getRadius();
+		if (std::fabs(radius - lastArc.getRadius()) > tolerance * (1 + radius)) return false;
+		if (!closePoints(firstArc.getCenterPoint(), lastArc.getCenterPoint(), 1 + radius)) return false;
+		if (firstArc.isCounterClockWise() != lastArc.isCounterClockWise()) return false;
+	}
+	return true;
+}
+
+
+void writeText(const char* text)
+{
+	FILE* file = std::fopen(path.c_str(), "wb");
+	std::fputs(text, file);
+	std::fclose(file);
+}
+
+
+void checkRoundTrip()
+{
+	auto polyLine = createPolyLine(10000);
+	{
+		DxfWriter writer(path);
+		CHECK(writer.isOpen());
+		writer.write(*polyLine);
+		writer.write(*polyLine);
+		CHECK(writer.close());
+	}
+
+	DxfReader reader(path);
+	auto first = reader.readPolyLine();
+	auto second = reader.readPolyLine();
+	CHECK(first && second);
+	if (first) CHECK(sameNodes(polyLine->getNodes(), first->getNodes()));
+	if (second) CHECK(sameNodes(polyLine->getNodes(), second->getNodes()));
+	CHECK(reader.readPolyLine() == nullptr);
+	CHECK(!reader.hasFailed());
+}
+
+
+void checkClosedPolyLine()
+{
+	writeText("0\nSECTION\n2\nENTITIES\n0\nLWPOLYLINE\n90\n3\n70\n1\n10\n0\n20\n0\n10\n1\n20\n0\n10\n1\n20\n1\n0\nENDSEC\n0\nEOF\n");
+	DxfReader reader(path);
+	auto polyLine = reader.readPolyLine();
+	CHECK(polyLine != nullptr);
+	if (!polyLine) return;
+
+	auto& nodes = polyLine->getNodes();
+	CHECK(nodes.size() == 4);									// closing section goes back to the first vertex
+	CHECK(closePoints(nodes.getEndPointAt(nodes.size() - 1), Point<double>(0, 0), 1));
+}
+
+
+void checkDamagedGroups()
+{
+	writeText("0\nSECTION\n2\nENTITIES\n0\nLWPOLYLINE\n90\n2\n70\nclosed\n10\n0\n20\n0\n10\n1\n20\n0\n0\nENDSEC\n0\nEOF\n");
+	DxfReader flagsReader(path);
+	CHECK(flagsReader.readPolyLine() == nullptr);
+	CHECK(flagsReader.hasFailed());
+
+	writeText("0\nSECTION\n2\nENTITIES\n0\nLWPOLYLINE\n90\n2\n10\n0\n20\nzero\n10\n1\n20\n0\n0\nENDSEC\n0\nEOF\n");
+	DxfReader coordinateReader(path);
+	CHECK(coordinateReader.readPolyLine() == nullptr);
+	CHECK(coordinateReader.hasFailed());
+}
+
+
+int main()
+{
+	checkRoundTrip();
+	checkClosedPolyLine();
+	checkDamagedGroups();
+	std::remove(path.c_str());
+	return tests::result();
+}
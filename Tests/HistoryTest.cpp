@@ -0,0 +1,86 @@
+// Redo brings back the nodes that undo removed, not rebuilt copies of them, so the polyline after undo and redo
+// has to be bit-identical to the one before (the same end points, arcs and vertexes)
+
+#include "Check.h"
+#include "Drawing.h"
+#include <vector>
+
+
+using namespace controler;
+using namespace tests;
+
+
+
+bool sameVertexes(VertexBuffer<double>& first, VertexBuffer<double>& last)
+{
+	if (first.size() != last.size()) return false;
+	for (size_t i = 0; i < first.size(); i++)
+		if ((first.getX()[i] != last.getX()[i]) || (first.getY()[i] != last.getY()[i])) return false;
+	return true;
+}
+
+
+void checkUndoRedo()
+{
+	HistoryHandler historyHandler(100000);
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+	auto points = createRandomPoints(2000, 5);
+	drawNodes(polyLineControler, points);
+	polyLineControler.setArcMaxDeviation(0.0001);
+
+	VertexBuffer<double> before;
+	polyLineControler.generateVertexChain(before);
+	vector<Point<double>> peakPointsBefore;
+	polyLineControler.generatePeakPoints(peakPointsBefore);
+
+	for (int i = 0; i < 700; i++)
+		historyHandler.undo();
+	VertexBuffer<double> undone;
+	polyLineControler.generateVertexChain(undone);
+	CHECK(undone.size() < before.size());
+
+	polyLineControler.setArcMaxDeviation(0.001);				// cache is made in other accuracy meanwhile, redo can't rely on it
+	VertexBuffer<double> otherAccuracy;
+	polyLineControler.generateVertexChain(otherAccuracy);
+	polyLineControler.setArcMaxDeviation(0.0001);
+
+	for (int i = 0; i < 700; i++)
+		historyHandler.redo();
+	CHECK(!historyHandler.canRedo());
+
+	VertexBuffer<double> after;
+	polyLineControler.generateVertexChain(after);
+	vector<Point<double>> peakPointsAfter;
+	polyLineControler.generatePeakPoints(peakPointsAfter);
+
+	CHECK(sameVertexes(before, after));
+	CHECK(peakPointsBefore.size() == peakPointsAfter.size());
+	for (size_t i = 0; (i < peakPointsBefore.size()) && (i < peakPointsAfter.size()); i++)
+		CHECK((peakPointsBefore[i].x == peakPointsAfter[i].x) && (peakPointsBefore[i].y == peakPointsAfter[i].y));
+}
+
+
+void checkNewNodeForgetsRedo()
+{
+	HistoryHandler historyHandler(100000);
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+	auto points = createRandomPoints(100, 7);
+	drawNodes(polyLineControler, points);
+
+	historyHandler.undo();
+	CHECK(historyHandler.canRedo());
+	auto point = Point<double>(0.5, 0.5);
+	polyLineControler.startAddingLines();
+	polyLineControler.addNode(point);
+	CHECK(!historyHandler.canRedo());							// removed node is forgotten, it can't be restored over the new one
+}
+
+
+int main()
+{
+	checkUndoRedo();
+	checkNewNodeForgetsRedo();
+	return tests::result();
+}
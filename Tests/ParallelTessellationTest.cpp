@@ -0,0 +1,69 @@
+// Nodes tessellated on pool write their vertexes to places found from the prefix sum of vertex counts, so the buffer has to be
+// byte-identical to the one made by one thread, for every accuracy, after nodes were removed and for visible chunks too
+
+#include "Check.h"
+#include "Drawing.h"
+#include <cstring>
+#include <vector>
+
+
+using namespace obj;
+using namespace tests;
+
+
+
+bool sameBytes(VertexBuffer<double>& first, VertexBuffer<double>& last)
+{
+	if (first.size() != last.size()) return false;
+	return (std::memcmp(first.getX(), last.getX(), first.size() * sizeof(double)) == 0)
+		&& (std::memcmp(first.getY(), last.getY(), first.size() * sizeof(double)) == 0);
+}
+
+
+void checkParallelTessellation()
+{
+	WorkStealingPool pool(4);
+	auto first = Point<double>(0, 0);
+	PolyLine serial(first);
+	PolyLine parallel(first);
+	parallel.setTessellationPool(&pool);
+
+	for (unsigned int round = 0; round < 3; round++)			// every round appends more nodes than minParallelNodes, then removes some
+	{
+		auto points = createRandomWalk(10000 + round * 7, round);
+		drawNodes(serial, points);
+		drawNodes(parallel, points);
+
+		for (auto accuracy : { ArcAccuracy(64), ArcAccuracy::fromDeviation(1e-4) })
+		{
+			VertexBuffer<double> serialVertexes;
+			VertexBuffer<double> parallelVertexes;
+			serial.generateVertexChain(serialVertexes, accuracy);
+			parallel.generateVertexChain(parallelVertexes, accuracy);
+			CHECK(sameBytes(serialVertexes, parallelVertexes));
+
+			auto area = serial.getBoundingBox();
+			VertexBuffer<double> serialVisible;
+			VertexBuffer<double> parallelVisible;
+			vector<size_t> serialStripEnds;
+			vector<size_t> parallelStripEnds;
+			serial.generateVisibleVertexChain(serialVisible, serialStripEnds, accuracy, area);
+			parallel.generateVisibleVertexChain(parallelVisible, parallelStripEnds, accuracy, area);
+			CHECK(sameBytes(serialVisible, parallelVisible));
+			CHECK(serialStripEnds == parallelStripEnds);
+		}
+
+		for (int i = 0; i < 1000; i++)
+		{
+			serial.removeLastNode();
+			parallel.removeLastNode();
+		}
+	}
+}
+
+
+int main()
+{
+	checkParallelTessellation();
+	return tests::result();
+}
@@ -0,0 +1,127 @@
+// Binary polyline file: saved and loaded polyline has to be the same, node by node, and damaged nodes (end point, arc radius or center
+// that isn't a finite number, radius that isn't positive) have to be rejected like any other damaged file
+
+#include "Check.h"
+#include "Drawing.h"
+#include "PolylineFile.h"
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+using namespace obj;
+using namespace tests;
+using std::string;
+using std::vector;
+
+
+
+const string path = "PolylineFileTest.p15";
+
+
+unique_ptr<PolyLine> createPolyLine(size_t count)
+{
+	auto firstPoint = Point<double>(0, 0);
+	auto polyLine = make_unique<PolyLine>(firstPoint);
+	auto points = createRandomPoints(count, 11);
+	drawNodes(*polyLine, points);
+	return polyLine;
+}
+
+
+bool samePoints(Point<double> first, Point<double> last)
+{
+	return (first.x == last.x) && (first.y == last.y);
+}
+
+
+bool sameNodes(NodeStore& first, NodeStore& last)
+{
+	if (first.size() != last.size()) return false;
+	for (size_t i = 0; i < first.size(); i++)
+	{
+		if (first.getKindAt(i) != last.getKindAt(i)) return false;
+		if (!samePoints(first.getEndPointAt(i), last.getEndPointAt(i))) return false;
+		if (first.getKindAt(i) != NodeKind::Arc) continue;
+
+		auto& firstArc = first.getArcAt(i);
+		auto& lastArc = last.getArcAt(i);
+		if (!samePoints(firstArc.getCenterPoint(), lastArc.getCenterPoint())) return false;
+		if (firstArc.getRadius() != lastArc.getRadius()) return false;
+		if (firstArc.getSweep() != lastArc.getSweep()) return false;
+		if (firstArc.isCounterClockWise() != lastArc.isCounterClockWise()) return false;
+		if (!samePoints(first.getPeakPointAt(i), last.getPeakPointAt(i))) return false;
+	}
+	return true;
+}
+
+
+void checkRoundTrip()
+{
+	auto polyLine = createPolyLine(10000);
+	CHECK(PolylineFile::save(*polyLine, path));
+
+	auto loaded = PolylineFile::load(path);
+	CHECK(loaded != nullptr);
+	if (loaded) CHECK(sameNodes(polyLine->getNodes(), loaded->getNodes()));
+}
+
+
+enum class DamagedField
+{
+	ArcRadius,													// of the first arc
+	ArcCenter,													// x of the first arc's center
+	EndPoint													// y of the last node's end point
+};
+
+
+// writes value over the field in saved file, the checksum isn't verified when it's loaded
+bool loadWithDamagedField(double value, DamagedField field)
+{
+	auto polyLine = createPolyLine(10);
+	if (!PolylineFile::save(*polyLine, path)) return true;
+
+	FILE* file = std::fopen(path.c_str(), "r+b");
+	PolylineFile::Header header;
+	std::fread(&header, sizeof(header), 1, file);
+	size_t kindsSize = (header.nodesCount + 7) / 8 * 8;
+	size_t endPoints = header.headerSize + kindsSize;
+	size_t arcCenters = endPoints + 2 * sizeof(double) * header.nodesCount;
+	size_t offset = arcCenters;
+	if (field == DamagedField::ArcRadius) offset = arcCenters + 2 * sizeof(double) * header.arcsCount;
+	if (field == DamagedField::EndPoint) offset = endPoints + 2 * sizeof(double) * (header.nodesCount - 1) + sizeof(double);
+	std::fseek(file, static_cast<long>(offset), SEEK_SET);
+	std::fwrite(&value, sizeof(double), 1, file);
+	std::fclose(file);
+
+	return (PolylineFile::load(path, false) != nullptr);
+}
+
+
+void checkDamagedNodes()
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	CHECK(loadWithDamagedField(0.5, DamagedField::ArcRadius));	// the damage itself is found, not the way file is changed
+	CHECK(!loadWithDamagedField(nan, DamagedField::ArcRadius));
+	CHECK(!loadWithDamagedField(-0.5, DamagedField::ArcRadius));
+	CHECK(!loadWithDamagedField(0, DamagedField::ArcRadius));
+	CHECK(!loadWithDamagedField(infinity, DamagedField::ArcRadius));
+	CHECK(!loadWithDamagedField(nan, DamagedField::ArcCenter));
+	CHECK(!loadWithDamagedField(-infinity, DamagedField::ArcCenter));
+	CHECK(loadWithDamagedField(0.5, DamagedField::EndPoint));
+	CHECK(!loadWithDamagedField(nan, DamagedField::EndPoint));
+	CHECK(!loadWithDamagedField(infinity, DamagedField::EndPoint));
+}
+
+
+int main()
+{
+	checkRoundTrip();
+	checkDamagedNodes();
+	std::remove(path.c_str());
+	return tests::result();
+}
@@ -0,0 +1,72 @@
+// Editing thread publishes snapshots while display thread takes them. Arrays of the taken snapshot may not change until the next one
+// is taken, although builder uses free arrays again, and the last taken snapshot is the same as one made after all moves
+
+#include "Check.h"
+#include "Drawing.h"
+#include "Scene.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+using namespace controler;
+using namespace tests;
+
+
+
+void checkPublishedSnapshots()
+{
+	auto points = createRandomWalk(2000, 7);
+	auto cursors = createRandomWalk(4000, 8);
+	HistoryHandler historyHandler;
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+	drawNodes(polyLineControler, points);
+	polyLineControler.startAddingArcs();
+
+	Camera camera(Size<double>(1024, 768), 384);
+	SceneBuilder sceneBuilder;
+	std::atomic<bool> editing{ true };
+	std::thread editingThread([&]
+	{
+		for (size_t i = 0; i < cursors.size(); i++)
+		{
+			polyLineControler.actualizePolyLine(cursors[i]);
+			if (i % 500 == 499) polyLineControler.addNode(cursors[i]);	// polyline arrays are made again too
+			sceneBuilder.publish(polyLineControler, camera);
+		}
+		editing = false;
+	});
+
+	size_t takenSnapshots = 0;
+	vector<float> preview;
+	vector<float> polyLine;
+	while (editing)
+	{
+		auto& snapshot = sceneBuilder.takeLatest();
+		if (snapshot.preview == nullptr) continue;
+		takenSnapshots++;
+		preview = snapshot.preview->vertexes;
+		polyLine = snapshot.polyLine->vertexes;
+		std::this_thread::yield();									// editing thread publishes a few more meanwhile
+		CHECK(snapshot.preview->vertexes == preview);
+		CHECK(snapshot.polyLine->vertexes == polyLine);
+	}
+	editingThread.join();
+	CHECK(takenSnapshots > 0);
+
+	SceneBuilder lastBuilder;
+	lastBuilder.publish(polyLineControler, camera);
+	auto& expected = lastBuilder.takeLatest();
+	auto& last = sceneBuilder.takeLatest();
+	CHECK(last.preview->vertexes == expected.preview->vertexes);
+	CHECK(last.polyLine->vertexes == expected.polyLine->vertexes);
+	CHECK(last.polyLine->stripEnds == expected.polyLine->stripEnds);
+}
+
+
+int main()
+{
+	checkPublishedSnapshots();
+	return tests::result();
+}
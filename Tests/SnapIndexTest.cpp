@@ -0,0 +1,87 @@
+// Snap index answers nearest point queries from grids of a few levels, so its answers are compared with brute force over all points,
+// for small radiuses and for ones that are bigger than the coarsest cells. Node queries find only end points and tell which node it is
+
+#include "Check.h"
+#include "PolylineControler.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+
+using namespace controler;
+using std::vector;
+
+
+
+void checkNearestPoints()
+{
+	std::mt19937 generator(13);
+	std::uniform_real_distribution<double> coordinate(-1, 1);
+	SnapIndex snapIndex;
+	vector<Point<double>> points;
+	for (int i = 0; i < 5000; i++)
+	{
+		points.push_back(Point<double>(coordinate(generator), coordinate(generator)));
+		snapIndex.add(points.back(), SnapKind::EndPoint);
+	}
+
+	for (double radius : { 0.001, 0.01, 0.5, 100.0 })
+		for (int i = 0; i < 200; i++)
+		{
+			auto point = Point<double>(2 * coordinate(generator), 2 * coordinate(generator));
+			double nearestDistance = std::numeric_limits<double>::infinity();
+			for (auto& candidate : points)
+				nearestDistance = std::fmin(nearestDistance, std::hypot(candidate.x - point.x, candidate.y - point.y));
+
+			SnapPoint nearest;
+			bool found = snapIndex.findNearest(point, radius, nearest);
+			CHECK(found == (nearestDistance <= radius));
+			if (found) CHECK(std::hypot(nearest.point.x - point.x, nearest.point.y - point.y) == nearestDistance);
+		}
+}
+
+
+void checkNodes()
+{
+	HistoryHandler historyHandler;
+	Document document;
+	PolyLineControler polyLineControler(historyHandler, document);
+	vector<Point<double>> points{ Point<double>(0, 0), Point<double>(1, 0), Point<double>(1, 1) };
+	for (auto& point : points)
+		polyLineControler.addNode(point);
+	polyLineControler.removePolyLine();						// finished polyline is the first one in document
+
+	vector<Point<double>> arcPoints{ Point<double>(5, 0), Point<double>(6, 0), Point<double>(6, 1) };
+	polyLineControler.addNode(arcPoints[0]);
+	polyLineControler.addNode(arcPoints[1]);
+	polyLineControler.startAddingArcs();
+	polyLineControler.addNode(arcPoints[2]);
+
+	SnapPoint node;
+	auto cursor = Point<double>(1.01, 0.98);
+	CHECK(polyLineControler.findNode(cursor, 0.1, node));
+	CHECK((node.polyLine == 0) && (node.nodeIndex == 2) && (node.kind == SnapKind::EndPoint));
+
+	cursor = Point<double>(6.01, 0.02);
+	CHECK(polyLineControler.findNode(cursor, 0.1, node));
+	CHECK((node.polyLine == 1) && (node.nodeIndex == 1));
+
+	SnapPoint nearest;												// the arc's center is nearer, but it isn't a node
+	cursor = Point<double>(5.6, 0.4);
+	CHECK(polyLineControler.findSnapPoint(cursor, 1, nearest) && (nearest.kind != SnapKind::EndPoint));
+	CHECK(polyLineControler.findNode(cursor, 1, node) && (node.kind == SnapKind::EndPoint));
+
+	cursor = Point<double>(6, 1);
+	CHECK(polyLineControler.selectNode(cursor, 0.1));
+	CHECK(polyLineControler.getSelectedNode(node) && (node.polyLine == 1) && (node.nodeIndex == 2));
+	historyHandler.undo();											// selected node is removed, so it isn't selected anymore
+	CHECK(!polyLineControler.getSelectedNode(node));
+}
+
+
+int main()
+{
+	checkNearestPoints();
+	checkNodes();
+	return tests::result();
+}